@@ -63,6 +63,7 @@ public:
 	~HunspellChecker();
 
 	bool checkWord (const char *word, size_t len);
+	void checkWords (const char *const *words, const size_t *lens, size_t n_words, int *results);
 	char **suggestWord (const char* const word, size_t len, size_t *out_n_suggs);
 	const char *getWordchars ();
 	bool apostropheIsWordChar;
@@ -70,6 +71,8 @@ public:
 	bool requestDictionary (const char * szLang);
 
 private:
+	bool convertWord (const char *word, size_t len, std::string &word8);
+
 	GIConv  m_translate_in; /* Selected translation from/to Unicode */
 	GIConv  m_translate_out;
 	Hunspell *hunspell;
@@ -97,61 +100,78 @@ HunspellChecker::~HunspellChecker()
 		g_iconv_close(m_translate_out);
 }
 
+/* NFC leaves ASCII as it is */
+static bool
+is_ascii(const char *word, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+		if (static_cast<unsigned char>(word[i]) >= 0x80)
+			return false;
+	return true;
+}
+
+// Puts the word into word8 in the dictionary encoding, keeping its buffer
+// so that it can serve word after word
 bool
-HunspellChecker::checkWord(const char *utf8Word, size_t len)
+HunspellChecker::convertWord(const char *utf8Word, size_t len, std::string &word8)
 {
 	if (len > MAXWORDLEN || !g_iconv_is_valid(m_translate_in))
 		return false;
 
 	// the 8bit encodings use precomposed forms
-	char *normalizedWord = g_utf8_normalize (utf8Word, len, G_NORMALIZE_NFC);
-	char *in = normalizedWord;
-	char word8[MAXWORDLEN + 1];
-	char *out = word8;
-	size_t len_in = strlen(in);
-	size_t len_out = sizeof( word8 ) - 1;
+	char *normalizedWord = nullptr;
+	char *in = const_cast<char *>(utf8Word);
+	size_t len_in = len;
+	if (!is_ascii(utf8Word, len)) {
+		normalizedWord = g_utf8_normalize (utf8Word, len, G_NORMALIZE_NFC);
+		in = normalizedWord;
+		len_in = strlen(in);
+	}
+	word8.resize(MAXWORDLEN);
+	char *out = &word8[0];
+	size_t len_out = MAXWORDLEN;
 	size_t result = g_iconv(m_translate_in, &in, &len_in, &out, &len_out);
 	g_free(normalizedWord);
 	if (static_cast<size_t>(-1) == result)
 		return false;
-	*out = '\0';
-	if (hunspell->spell(std::string(word8)))
-		return true;
-	else
-		return false;
+	word8.resize(out - word8.data());
+	return true;
+}
+
+bool
+HunspellChecker::checkWord(const char *utf8Word, size_t len)
+{
+	std::string word8;
+	return convertWord(utf8Word, len, word8) && hunspell->spell(word8);
+}
+
+void
+HunspellChecker::checkWords(const char *const *utf8Words, const size_t *lens, size_t n_words, int *results)
+{
+	// one buffer serves all the words
+	std::string word8;
+	word8.reserve(MAXWORDLEN);
+	for (size_t i = 0; i < n_words; i++)
+		results[i] = !(convertWord(utf8Words[i], lens[i], word8) && hunspell->spell(word8));
 }
 
 char**
 HunspellChecker::suggestWord(const char* const utf8Word, size_t len, size_t *nsug)
 {
-	if (len > MAXWORDLEN 
-		|| !g_iconv_is_valid(m_translate_in)
-		|| !g_iconv_is_valid(m_translate_out))
+	std::string word8;
+	if (!g_iconv_is_valid(m_translate_out) || !convertWord(utf8Word, len, word8))
 		return nullptr;
 
-	// the 8bit encodings use precomposed forms
-	char *normalizedWord = g_utf8_normalize (utf8Word, len, G_NORMALIZE_NFC);
-	char *in = normalizedWord;
-	char word8[MAXWORDLEN + 1];
-	char *out = word8;
-	size_t len_in = strlen(in);
-	size_t len_out = sizeof(word8) - 1;
-	size_t result = g_iconv(m_translate_in, &in, &len_in, &out, &len_out);
-	g_free(normalizedWord);
-	if (static_cast<size_t>(-1) == result)
-		return nullptr;
-
-	*out = '\0';
 	std::vector<std::string> sugMS = hunspell->suggest(word8);
 	*nsug = sugMS.size();
 	if (*nsug > 0) {
 		char **sug = g_new0 (char *, *nsug + 1);
 		for (size_t i=0; i<*nsug; i++) {
-			in = const_cast<char *>(sugMS[i].c_str());
-			len_in = strlen(in);
-			len_out = MAXWORDLEN;
+			char *in = const_cast<char *>(sugMS[i].c_str());
+			size_t len_in = strlen(in);
+			size_t len_out = MAXWORDLEN;
 			char *word = g_new0(char, len_out + 1);
-			out = word;
+			char *out = word;
 			if (static_cast<size_t>(-1) == g_iconv(m_translate_out, &in, &len_in, &out, &len_out)) {
 				*nsug = i;
 				break;
@@ -353,6 +373,14 @@ hunspell_dict_check (EnchantDict * me, const char *const word, size_t len)
 	return 1;
 }
 
+static void
+hunspell_dict_check_batch (EnchantDict * me, const char *const *const words,
+			   const size_t * lens, size_t n_words, int * results)
+{
+	HunspellChecker * checker = static_cast<HunspellChecker *>(me->user_data);
+	checker->checkWords(words, lens, n_words, results);
+}
+
 static const char*
 hunspell_dict_get_extra_word_characters (EnchantDict *me)
 {
@@ -449,6 +477,7 @@ hunspell_provider_request_dict(EnchantProvider * me _GL_UNUSED_PARAMETER, const
 	EnchantDict *dict = g_new0(EnchantDict, 1);
 	dict->user_data = (void *) checker;
 	dict->check = hunspell_dict_check;
+	dict->check_batch = hunspell_dict_check_batch;
 	dict->suggest = hunspell_dict_suggest;
 	// don't implement personal, session
 	dict->get_extra_word_characters = hunspell_dict_get_extra_word_characters;
@@ -518,4 +547,12 @@ init_enchant_provider (void)
 	return provider;
 }
 
+int enchant_provider_abi_version (void);
+
+int
+enchant_provider_abi_version (void)
+{
+	return ENCHANT_PROVIDER_ABI_VERSION;
+}
+
 } // extern C linkage
@@ -59,6 +59,7 @@ class NuspellChecker
 {
 public:
 	bool checkWord (const char *word, size_t len);
+	void checkWords (const char *const *words, const size_t *lens, size_t n_words, int *results);
 	char **suggestWord (const char* const word, size_t len, size_t *out_n_suggs);
 
 	bool requestDictionary (const char * szLang);
@@ -69,24 +70,57 @@ private:
 
 /***************************************************************************/
 
-bool
-NuspellChecker::checkWord(const char *utf8Word, size_t len)
+/* NFC leaves ASCII as it is */
+static bool
+is_ascii(const char *word, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+		if (static_cast<unsigned char>(word[i]) >= 0x80)
+			return false;
+	return true;
+}
+
+// Puts the word into word, keeping its buffer so that it can serve word
+// after word
+static void
+normalizeWord(const char *utf8Word, size_t len, string &word)
 {
 	// the 8-bit encodings use precomposed forms
+	if (is_ascii(utf8Word, len)) {
+		word.assign(utf8Word, len);
+		return;
+	}
 	char *normalizedWord = g_utf8_normalize (utf8Word, len, G_NORMALIZE_NFC);
-	auto ret = nuspell.spell(normalizedWord);
+	word.assign(normalizedWord);
 	g_free(normalizedWord);
-	return ret;
+}
+
+bool
+NuspellChecker::checkWord(const char *utf8Word, size_t len)
+{
+	string word;
+	normalizeWord(utf8Word, len, word);
+	return nuspell.spell(word);
+}
+
+void
+NuspellChecker::checkWords(const char *const *utf8Words, const size_t *lens, size_t n_words, int *results)
+{
+	// one buffer serves all the words
+	string word;
+	for (size_t i = 0; i < n_words; i++) {
+		normalizeWord(utf8Words[i], lens[i], word);
+		results[i] = !nuspell.spell(word);
+	}
 }
 
 char**
 NuspellChecker::suggestWord(const char* const utf8Word, size_t len, size_t *nsug)
 {
-	// the 8-bit encodings use precomposed forms
-	char *normalizedWord = g_utf8_normalize (utf8Word, len, G_NORMALIZE_NFC);
+	string word;
+	normalizeWord(utf8Word, len, word);
 	auto suggestions = vector<string>();
-	nuspell.suggest(normalizedWord, suggestions);
-	g_free(normalizedWord);
+	nuspell.suggest(word, suggestions);
 	if (suggestions.empty())
 		return nullptr;
 	*nsug = suggestions.size();
@@ -285,6 +319,14 @@ nuspell_dict_check (EnchantDict * me, const char *const word, size_t len)
 	return !(checker->checkWord(word, len));
 }
 
+static void
+nuspell_dict_check_batch (EnchantDict * me, const char *const *const words,
+			  const size_t * lens, size_t n_words, int * results)
+{
+	NuspellChecker * checker = static_cast<NuspellChecker *>(me->user_data);
+	checker->checkWords(words, lens, n_words, results);
+}
+
 static int
 nuspell_dict_is_word_character (EnchantDict * me _GL_UNUSED_PARAMETER,
 				uint32_t uc, size_t n _GL_UNUSED_PARAMETER)
@@ -366,6 +408,7 @@ nuspell_provider_request_dict(EnchantProvider * me _GL_UNUSED_PARAMETER, const c
 	EnchantDict *dict = g_new0(EnchantDict, 1);
 	dict->user_data = (void *) checker;
 	dict->check = nuspell_dict_check;
+	dict->check_batch = nuspell_dict_check_batch;
 	dict->suggest = nuspell_dict_suggest;
 	// don't implement personal, session
 	dict->is_word_character = nuspell_dict_is_word_character;
@@ -433,4 +476,12 @@ init_enchant_provider (void)
 	return provider;
 }
 
+int enchant_provider_abi_version (void);
+
+int
+enchant_provider_abi_version (void)
+{
+	return ENCHANT_PROVIDER_ABI_VERSION;
+}
+
 } // extern C linkage
@@ -31,6 +31,7 @@
 #define ENCHANT_PLUS_PLUS_H
 
 #include <enchant.h>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <exception>
@@ -89,6 +90,24 @@ namespace enchant
 				return false; // never reached
 			}
 
+			void check_many (const std::vector<std::string> & utf8words,
+					 std::vector<bool> & out_correct) {
+				std::vector<const char *> words;
+				std::vector<ssize_t> lens;
+				std::vector<int> vals (utf8words.size ());
+				get_words (utf8words, words, lens);
+				enchant_dict_check_many (m_dict, words.empty () ? NULL : &words[0],
+							 lens.empty () ? NULL : &lens[0], words.size (),
+							 vals.empty () ? NULL : &vals[0]);
+
+				out_correct.resize (vals.size ());
+				for (size_t i = 0; i < vals.size (); i++) {
+					if (vals[i] < 0)
+						throw enchant::Exception (enchant_dict_get_error (m_dict));
+					out_correct[i] = vals[i] == 0;
+				}
+			}
+
 			void suggest (const std::string & utf8word, 
 				      std::vector<std::string> & out_suggestions) {
 				size_t n_suggs;
@@ -96,17 +115,20 @@ namespace enchant
 				
 				out_suggestions.clear ();
 				
-				suggs = enchant_dict_suggest (m_dict, utf8word.c_str(), 
-							      utf8word.size(), &n_suggs);
+				suggs = enchant_dict_suggest_packed (m_dict, utf8word.c_str(), 
+								     utf8word.size(), &n_suggs);
 				
-				if (suggs && n_suggs) {
-					out_suggestions.reserve(n_suggs);
+				if (suggs) {
+					out_suggestions.resize(n_suggs);
 
+					/* The strings follow one another, so their lengths are known */
 					for (size_t i = 0; i < n_suggs; i++) {
-						out_suggestions.push_back (suggs[i]);
+						size_t len = i + 1 < n_suggs ?
+							suggs[i + 1] - suggs[i] - 1 : strlen (suggs[i]);
+						out_suggestions[i].assign (suggs[i], len);
 					}
 					
-					enchant_dict_free_string_list (m_dict, suggs);
+					enchant_dict_free_packed_string_list (m_dict, suggs);
 				}
 			}
 						
@@ -116,11 +138,27 @@ namespace enchant
 				return result;
 			}
 			
+			void set_check_cache_size (size_t n_entries) {
+				enchant_dict_set_check_cache_size (m_dict, n_entries);
+			}
+
+			void set_suggest_cache_size (size_t n_entries, size_t n_bytes) {
+				enchant_dict_set_suggest_cache_size (m_dict, n_entries, n_bytes);
+			}
+
 			void add (const std::string & utf8word) {
 				enchant_dict_add (m_dict, utf8word.c_str(), 
 							 utf8word.size());
 			}
 			
+			void add_many (const std::vector<std::string> & utf8words) {
+				std::vector<const char *> words;
+				std::vector<ssize_t> lens;
+				get_words (utf8words, words, lens);
+				enchant_dict_add_many (m_dict, words.empty () ? NULL : &words[0],
+						       lens.empty () ? NULL : &lens[0], words.size ());
+			}
+			
 			void add_to_session (const std::string & utf8word) {
 				enchant_dict_add_to_session (m_dict, utf8word.c_str(), 
 							     utf8word.size());
@@ -136,6 +174,14 @@ namespace enchant
 							 utf8word.size());
 			}
 			
+			void remove_many (const std::vector<std::string> & utf8words) {
+				std::vector<const char *> words;
+				std::vector<ssize_t> lens;
+				get_words (utf8words, words, lens);
+				enchant_dict_remove_many (m_dict, words.empty () ? NULL : &words[0],
+							  lens.empty () ? NULL : &lens[0], words.size ());
+			}
+			
 			void remove_from_session (const std::string & utf8word) {
 				enchant_dict_remove_from_session (m_dict, utf8word.c_str(), 
 							     utf8word.size());
@@ -174,6 +220,17 @@ namespace enchant
 			// space reserved for API/ABI expansion
 			void * _private[5];		       
 
+			static void get_words (const std::vector<std::string> & utf8words,
+					       std::vector<const char *> & words,
+					       std::vector<ssize_t> & lens) {
+				words.reserve (utf8words.size ());
+				lens.reserve (utf8words.size ());
+				for (size_t i = 0; i < utf8words.size (); i++) {
+					words.push_back (utf8words[i].c_str ());
+					lens.push_back (utf8words[i].size ());
+				}
+			}
+
 			static void s_describe_fn (const char * const lang,
 						   const char * const provider_name,
 						   const char * const provider_desc,
@@ -252,6 +309,10 @@ namespace enchant
 				enchant_broker_set_ordering (m_broker, tag.c_str(), ordering.c_str());
 			}
 			
+			void set_pwl_refresh_policy (EnchantPWLRefreshPolicy policy, unsigned int interval_ms = 0) {
+				enchant_broker_set_pwl_refresh_policy (m_broker, policy, interval_ms);
+			}
+			
 			void describe (EnchantBrokerDescribeFn fn, void * user_data = NULL) {
 				enchant_broker_describe (m_broker, fn, user_data);
 			}
@@ -98,6 +98,20 @@ void enchant_dict_set_error (EnchantDict * dict, const char * const err);
  */
 void enchant_provider_set_error (EnchantProvider * provider, const char * const err);
 
+/**
+ * ENCHANT_PROVIDER_ABI_VERSION
+ *
+ * The version of the structures below, which grow at the end.  A provider
+ * built against this header gives it by exporting
+ *
+ *   int enchant_provider_abi_version (void);
+ *
+ * returning ENCHANT_PROVIDER_ABI_VERSION, so that the members it did not
+ * know of are not read.  A provider not exporting it is taken to be at
+ * version 1.
+ */
+#define ENCHANT_PROVIDER_ABI_VERSION 2
+
 struct str_enchant_dict
 {
 	void *user_data;
@@ -128,6 +142,14 @@ struct str_enchant_dict
 
 	int (*is_word_character) (struct str_enchant_dict * me,
 				  uint32_t uc_in, size_t n);
+
+	/* optional, and read only from providers giving an
+	   ENCHANT_PROVIDER_ABI_VERSION of 2 or more; checks the words as check
+	   would, storing the results in @results. When NULL, check is called
+	   for each word */
+	void (*check_batch) (struct str_enchant_dict * me,
+			     const char *const *const words, const size_t * lens,
+			     size_t n_words, int * results);
 };
 	
 struct str_enchant_provider
@@ -113,6 +113,47 @@ int enchant_broker_dict_exists (EnchantBroker * broker, const char * const tag);
 void enchant_broker_set_ordering (EnchantBroker * broker,
                                   const char * const tag,
 				  const char * const ordering);
+/**
+ * EnchantPWLRefreshPolicy
+ * @ENCHANT_PWL_REFRESH_ALWAYS: Look for changes on every check, suggestion,
+ * addition and removal. This is the default.
+ * @ENCHANT_PWL_REFRESH_THROTTLED: Look for changes at most once per interval.
+ * @ENCHANT_PWL_REFRESH_NOTIFY: Look for changes only after being notified of
+ * them by the operating system (inotify). Where notifications are not
+ * available, behaves as %ENCHANT_PWL_REFRESH_THROTTLED.
+ *
+ * How personal word lists notice changes made to their files by other
+ * processes.
+ */
+typedef enum {
+	ENCHANT_PWL_REFRESH_ALWAYS,
+	ENCHANT_PWL_REFRESH_THROTTLED,
+	ENCHANT_PWL_REFRESH_NOTIFY
+} EnchantPWLRefreshPolicy;
+
+/**
+ * enchant_broker_set_pwl_refresh_policy
+ * @broker: A non-null #EnchantBroker
+ * @policy: An #EnchantPWLRefreshPolicy
+ * @interval_ms: The time between looking for changes in milliseconds, for
+ * %ENCHANT_PWL_REFRESH_THROTTLED
+ *
+ * Declares how the personal word lists and exclude lists of the dictionaries
+ * of @broker, already requested or requested later, look for changes made to
+ * their files by other processes. Looking less often saves a stat() of each
+ * list per word checked, at the price of seeing changes by other processes
+ * later. Changes made through the dictionaries themselves are always seen
+ * immediately.
+ *
+ * The dictionaries of all the brokers of a process share the word lists of
+ * the same files, which look for changes as last declared for any of them.
+ * A broker which declares no policy leaves the lists it shares as they are,
+ * and those only it opens look for changes as %ENCHANT_PWL_REFRESH_ALWAYS.
+ */
+void enchant_broker_set_pwl_refresh_policy (EnchantBroker * broker,
+					    EnchantPWLRefreshPolicy policy,
+					    unsigned int interval_ms);
+
 /**
  * enchant_broker_get_error
  * @broker: A non-null broker
@@ -163,6 +204,46 @@ void enchant_broker_describe (EnchantBroker * broker,
  */
 int enchant_dict_check (EnchantDict * dict, const char *const word, ssize_t len);
 
+/**
+ * enchant_dict_check_many
+ * @dict: A non-null #EnchantDict
+ * @words: The non-null words you wish to check, in UTF-8 encoding
+ * @lens: The byte lengths of @words, each -1 for strlen of the word, or %null for strlen of all of them
+ * @n_words: The number of @words
+ * @results: The location to store the @n_words results
+ *
+ * Checks the words as enchant_dict_check() would, storing what it would
+ * return for each in @results, but hands the words the dictionary cannot
+ * answer itself to the provider at once. Every result is negative if any
+ * of the words is empty or not valid UTF-8.
+ */
+void enchant_dict_check_many (EnchantDict * dict, const char *const *words,
+			      const ssize_t *lens, size_t n_words, int *results);
+
+/**
+ * enchant_dict_set_check_cache_size
+ * @dict: A non-null #EnchantDict
+ * @n_entries: The most results of enchant_dict_check() to remember, or 0 for none
+ *
+ * Sets how many results of enchant_dict_check() the dictionary remembers,
+ * forgetting those it has. The words checked most often are kept. They are
+ * all forgotten when a word is added to or removed from the dictionary or
+ * session, or when the personal or exclude dictionary changes otherwise.
+ * By default 4096 results are remembered.
+ */
+void enchant_dict_set_check_cache_size (EnchantDict * dict, size_t n_entries);
+
+/**
+ * enchant_dict_get_check_cache_stats
+ * @dict: A non-null #EnchantDict
+ * @n_hits: The location to store the # of checks answered from remembered results, or %null
+ * @n_misses: The location to store the # of checks which were not, or %null
+ *
+ * Counts the checks since the dictionary was requested; checks made while
+ * remembering no results are not counted.
+ */
+void enchant_dict_get_check_cache_stats (EnchantDict * dict, size_t * n_hits, size_t * n_misses);
+
 /**
  * enchant_dict_suggest
  * @dict: A non-null #EnchantDict
@@ -178,6 +259,48 @@ int enchant_dict_check (EnchantDict * dict, const char *const word, ssize_t len)
 char **enchant_dict_suggest (EnchantDict * dict, const char *const word,
                              ssize_t len, size_t * out_n_suggs);
 
+/**
+ * enchant_dict_suggest_packed
+ * @dict: A non-null #EnchantDict
+ * @word: The non-null word you wish to find suggestions for, in UTF-8 encoding
+ * @len: The byte length of @word, or -1 for strlen (@word)
+ * @out_n_suggs: The location to store the # of suggestions returned, or %null
+ *
+ * Gives the suggestions enchant_dict_suggest() would, in one block of memory
+ * holding the list followed by the strings. Free it with
+ * enchant_dict_free_packed_string_list().
+ *
+ * Returns: A %null terminated list of UTF-8 encoded suggestions, or %null
+ */
+char **enchant_dict_suggest_packed (EnchantDict * dict, const char *const word,
+				    ssize_t len, size_t * out_n_suggs);
+
+/**
+ * enchant_dict_set_suggest_cache_size
+ * @dict: A non-null #EnchantDict
+ * @n_entries: The most results of enchant_dict_suggest() to remember, or 0 for none
+ * @n_bytes: The most bytes the remembered results may take, or 0 for none
+ *
+ * Sets how many results of enchant_dict_suggest() the dictionary remembers,
+ * forgetting those it has. The results asked for last are kept, and are
+ * copied for each call. They are all forgotten when a word is added to or
+ * removed from the dictionary or session, when the personal or exclude
+ * dictionary changes otherwise, or when a replacement is stored. By default
+ * 128 results are remembered, in up to 64 KiB.
+ */
+void enchant_dict_set_suggest_cache_size (EnchantDict * dict, size_t n_entries, size_t n_bytes);
+
+/**
+ * enchant_dict_get_suggest_cache_stats
+ * @dict: A non-null #EnchantDict
+ * @n_hits: The location to store the # of suggestions answered from remembered results, or %null
+ * @n_misses: The location to store the # of suggestions which were not, or %null
+ *
+ * Counts the suggestions since the dictionary was requested; suggestions made
+ * while remembering no results are not counted.
+ */
+void enchant_dict_get_suggest_cache_stats (EnchantDict * dict, size_t * n_hits, size_t * n_misses);
+
 /**
  * enchant_dict_add
  * @dict: A non-null #EnchantDict
@@ -189,6 +312,20 @@ char **enchant_dict_suggest (EnchantDict * dict, const char *const word,
  */
 void enchant_dict_add (EnchantDict * dict, const char *const word, ssize_t len);
 
+/**
+ * enchant_dict_add_many
+ * @dict: A non-null #EnchantDict
+ * @words: The non-null words you wish to add to your personal dictionary, in UTF-8 encoding
+ * @lens: The byte lengths of @words, each -1 for strlen of the word, or %null for strlen of all of them
+ * @n_words: The number of @words
+ *
+ * Adds the words as enchant_dict_add() would, but writes them to
+ * the personal dictionary at once. Nothing is added if any of the
+ * words is empty or not valid UTF-8.
+ */
+void enchant_dict_add_many (EnchantDict * dict, const char *const *words,
+			    const ssize_t *lens, size_t n_words);
+
 /**
  * enchant_dict_add_to_session
  * @dict: A non-null #EnchantDict
@@ -205,9 +342,29 @@ void enchant_dict_add_to_session (EnchantDict * dict, const char *const word, ss
  *        remove from the personal dictionary, in UTF-8 encoding
  * @len: The byte length of @word, or -1 for strlen (@word)
  *
+ * The removal is written to the personal dictionary file as a line of
+ * its own, which older versions of Enchant skip. A file of up to 64 KiB
+ * is rewritten without the word at once; a larger one only once most of
+ * its lines are removals, and until then older versions of Enchant
+ * reading it still accept the word.
  */
 void enchant_dict_remove (EnchantDict * dict, const char *const word, ssize_t len);
 
+/**
+ * enchant_dict_remove_many
+ * @dict: A non-null #EnchantDict
+ * @words: The non-null words you wish to add to your exclude dictionary and
+ *         remove from the personal dictionary, in UTF-8 encoding
+ * @lens: The byte lengths of @words, each -1 for strlen of the word, or %null for strlen of all of them
+ * @n_words: The number of @words
+ *
+ * Removes the words as enchant_dict_remove() would, but writes them to
+ * the personal and exclude dictionaries at once. Nothing is removed if
+ * any of the words is empty or not valid UTF-8.
+ */
+void enchant_dict_remove_many (EnchantDict * dict, const char *const *words,
+			       const ssize_t *lens, size_t n_words);
+
 /**
  * enchant_dict_remove_from_session
  * @dict: A non-null #EnchantDict
@@ -258,6 +415,15 @@ void enchant_dict_store_replacement (EnchantDict * dict,
  */
 void enchant_dict_free_string_list (EnchantDict * dict, char **string_list);
 
+/**
+ * enchant_dict_free_packed_string_list
+ * @dict: A non-null #EnchantDict
+ * @string_list: A string list returned from enchant_dict_suggest_packed, or %null
+ *
+ * Releases the string list, strings and all
+ */
+void enchant_dict_free_packed_string_list (EnchantDict * dict, char **string_list);
+
 /**
  * enchant_dict_get_error
  * @dict: A non-null #EnchantDict
@@ -59,15 +59,51 @@ struct str_enchant_broker
 	GHashTable *dict_map;		/* map of language tag -> dictionary */
 	GHashTable *provider_ordering; /* map of language tag -> provider order */
 
+	EnchantPWLRefreshPolicy pwl_refresh_policy;
+	unsigned int pwl_refresh_interval;
+	gboolean pwl_refresh_policy_set;	/* else the shared lists are left as they are */
+
 	gchar * error;
 };
 
+/* What the session knows of a word */
+typedef enum
+{
+	ENCHANT_SESSION_UNKNOWN,
+	ENCHANT_SESSION_INCLUDED,
+	ENCHANT_SESSION_EXCLUDED
+} EnchantSessionWord;
+
+/*  The words added to or removed from a session are kept in an open
+ *  addressing hash table keyed by pointer and length, so that a word is
+ *  looked up where it lies in the caller's text, without copying it.
+ *  The table holds copies of the words made in a string arena, which is
+ *  freed with the session.
+ */
+typedef struct str_enchant_session_slot
+{
+	const char *word;		/* in the arena, or NULL if the slot is empty */
+	size_t len;
+	guint hash;
+	EnchantSessionWord state;
+} EnchantSessionSlot;
+
 typedef struct str_enchant_session
 {
-	GHashTable *session_include;
-	GHashTable *session_exclude;
+	EnchantSessionSlot *session_words;	/* words added to or removed from the session */
+	guint n_session_slots;		/* a power of two, or 0 */
+	guint n_session_words;
+	GStringChunk *session_strings;	/* NULL until a word is added or removed */
 	EnchantPWL *personal;
-	EnchantPWL *exclude;
+	EnchantPWL *exclude;		/* NULL until its file has words or one is excluded */
+	uint64_t personal_generation;	/* of the lists as the session last saw them, or 0 */
+	uint64_t exclude_generation;
+	gint64 exclude_looked_for;	/* when its file was last found missing or empty, or 0 */
+
+	EnchantPWLRefreshPolicy pwl_refresh_policy;
+	unsigned int pwl_refresh_interval;
+	gboolean pwl_refresh_policy_set;	/* by the broker */
+	gboolean pwl_compiled_index;	/* the lists are enchant's own, in the user config dir */
 
 	char * personal_filename;
 	char * exclude_filename;
@@ -80,14 +116,85 @@ typedef struct str_enchant_session
 	EnchantProvider * provider;
 } EnchantSession;
 
+/*  The final results of enchant_dict_check for the words checked most
+ *  often, which in running text are a few thousand.  Entries are evicted
+ *  by the CLOCK algorithm: a hit marks an entry, and the hand clears the
+ *  marks it passes until it comes to an unmarked entry to evict.  Any
+ *  change to the lists or session drops all of them: which cached words
+ *  a word added or removed matches depends on the case rules of the
+ *  locale, so telling them apart would cost more than checking again.
+ */
+#define ENCHANT_CHECK_CACHE_DEFAULT_SIZE 4096
+#define ENCHANT_CHECK_CACHE_MIN_ENTRIES 64
+
+typedef struct str_enchant_check_entry
+{
+	char *word;
+	size_t len;
+	guint hash;
+	int result;
+	gboolean referenced;
+} EnchantCheckEntry;
+
+typedef struct str_enchant_check_cache
+{
+	EnchantCheckEntry *entries;	/* NULL until a result is cached */
+	size_t n_entries;
+	size_t n_allocated;		/* grows up to size */
+	size_t size;			/* the most entries kept, 0 to disable the cache */
+	size_t hand;
+	GHashTable *index;		/* of the entries by word */
+
+	size_t n_hits;
+	size_t n_misses;
+} EnchantCheckCache;
+
+/*  The lists of enchant_dict_suggest for the words last asked about, as
+ *  editors ask again for the same misspelling whenever they show a menu.
+ *  The lists are kept for one generation of the dictionary, and dropped
+ *  once the words of its lists or session change.  The least recently
+ *  used lists are evicted to keep within a number of lists and of bytes.
+ */
+#define ENCHANT_SUGGEST_CACHE_DEFAULT_SIZE 128
+#define ENCHANT_SUGGEST_CACHE_DEFAULT_BYTES (64 * 1024)
+
+typedef struct str_enchant_suggest_entry
+{
+	char *word;
+	size_t len;
+	guint hash;
+	char **suggs;			/* packed into one block */
+	size_t n_suggs;
+	size_t n_bytes;			/* counted against the limit */
+	GList link;			/* in the queue of recently used entries */
+} EnchantSuggestEntry;
+
+typedef struct str_enchant_suggest_cache
+{
+	GHashTable *index;		/* of the entries by word, NULL until a list is cached */
+	GQueue recent;			/* of the entries, most recently used first */
+	uint64_t generation;		/* of the dictionary the lists were made in */
+	size_t n_bytes;
+	size_t size;			/* the most lists kept, 0 to disable the cache */
+	size_t max_bytes;
+
+	size_t n_hits;
+	size_t n_misses;
+} EnchantSuggestCache;
+
 typedef struct str_enchant_dict_private_data
 {
 	unsigned int reference_count;
 	EnchantSession* session;
+	uint64_t generation;		/* bumped whenever the words of the lists or session change */
+	EnchantCheckCache check_cache;
+	EnchantSuggestCache suggest_cache;
+	int provider_abi_version;	/* of the provider which made the dictionary */
 } EnchantDictPrivateData;
 
 typedef EnchantProvider *(*EnchantProviderInitFunc) (void);
 typedef void             (*EnchantPreConfigureFunc) (EnchantProvider * provider, const char * module_dir);
+typedef int              (*EnchantProviderAbiVersionFunc) (void);
 
 /********************************************************************************/
 /********************************************************************************/
@@ -216,10 +323,12 @@ enchant_iso_639_from_tag (const char * const dict_tag)
 static void
 enchant_session_destroy (EnchantSession * session)
 {
-	g_hash_table_destroy (session->session_include);
-	g_hash_table_destroy (session->session_exclude);
+	g_free (session->session_words);
+	if (session->session_strings)
+		g_string_chunk_free (session->session_strings);
 	enchant_pwl_free (session->personal);
-	enchant_pwl_free (session->exclude);
+	if (session->exclude)
+		enchant_pwl_free (session->exclude);
 	g_free (session->personal_filename);
 	g_free (session->exclude_filename);
 	free (session->language_tag);
@@ -239,7 +348,7 @@ enchant_session_new_with_pwl (EnchantProvider * provider,
 {
 	EnchantPWL *personal = NULL;
 	if (pwl)
-		personal = enchant_pwl_init_with_file (pwl);
+		personal = enchant_pwl_init_with_file_shared (pwl);
 	if (personal == NULL) {
 		if (fail_if_no_pwl)
 			return NULL;
@@ -247,17 +356,8 @@ enchant_session_new_with_pwl (EnchantProvider * provider,
 			personal = enchant_pwl_init ();
 	}
 
-	EnchantPWL *exclude = NULL;
-	if (excl)
-		exclude = enchant_pwl_init_with_file (excl);
-	if (exclude == NULL)
-		exclude = enchant_pwl_init ();
-
 	EnchantSession * session = g_new0 (EnchantSession, 1);
-	session->session_include = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
-	session->session_exclude = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	session->personal = personal;
-	session->exclude = exclude;
 	session->provider = provider;
 	session->language_tag = strdup (lang);
 	session->personal_filename = g_strdup (pwl); /* Need g_strdup because may be NULL */
@@ -282,6 +382,13 @@ _enchant_session_new (EnchantProvider *provider, const char * const user_config_
 	g_free (filename);
 
 	EnchantSession * session = enchant_session_new_with_pwl (provider, dic, excl, lang, fail_if_no_pwl);
+	/* The index takes a few times the space of the list, which is only
+	 * worth spending on enchant's own lists */
+	if (session)
+		{
+			session->pwl_compiled_index = TRUE;
+			enchant_pwl_set_compiled_index (session->personal, TRUE);
+		}
 
 	g_free (dic);
 	g_free (excl);
@@ -308,71 +415,263 @@ enchant_session_new (EnchantProvider *provider, const char * const lang)
 	return session;
 }
 
+static void
+enchant_session_set_pwl_refresh_policy (EnchantSession * session, EnchantPWLRefreshPolicy policy,
+					unsigned int interval_ms)
+{
+	session->pwl_refresh_policy = policy;
+	session->pwl_refresh_interval = interval_ms;
+	session->pwl_refresh_policy_set = TRUE;
+	enchant_pwl_set_refresh_policy (session->personal, policy, interval_ms);
+	if (session->exclude)
+		enchant_pwl_set_refresh_policy (session->exclude, policy, interval_ms);
+}
+
+/* The exclude list is opened or created when a word is to be excluded;
+ * see enchant_session_find_exclude */
+static EnchantPWL *
+enchant_session_get_exclude (EnchantSession * session)
+{
+	if (session->exclude == NULL)
+		{
+			if (session->exclude_filename)
+				session->exclude = enchant_pwl_init_with_file_shared (session->exclude_filename);
+			if (session->exclude == NULL)
+				session->exclude = enchant_pwl_init ();
+			if (session->pwl_refresh_policy_set)
+				enchant_pwl_set_refresh_policy (session->exclude, session->pwl_refresh_policy,
+								session->pwl_refresh_interval);
+			if (session->pwl_compiled_index)
+				enchant_pwl_set_compiled_index (session->exclude, TRUE);
+		}
+
+	return session->exclude;
+}
+
+/* Returns: the exclude list, or NULL while there is none.  Opening its file
+ * would create it and most are never written, so it is only opened once it
+ * has words in it; until then it is looked for as the refresh policy says */
+static EnchantPWL *
+enchant_session_find_exclude (EnchantSession * session)
+{
+	if (session->exclude != NULL || session->exclude_filename == NULL)
+		return session->exclude;
+
+	if (session->pwl_refresh_policy_set &&
+	    session->pwl_refresh_policy != ENCHANT_PWL_REFRESH_ALWAYS)
+		{
+			gint64 now = g_get_monotonic_time ();
+			if (session->exclude_looked_for != 0 &&
+			    now - session->exclude_looked_for < (gint64) session->pwl_refresh_interval * 1000)
+				return NULL;
+			session->exclude_looked_for = now;
+		}
+
+	GStatBuf stats;
+	if (g_stat (session->exclude_filename, &stats) != 0 || stats.st_size == 0)
+		return NULL;
+
+	return enchant_session_get_exclude (session);
+}
+
+static guint
+enchant_session_hash (const char * const word, size_t len)
+{
+	guint hash = 5381;
+	for (size_t i = 0; i < len; i++)
+		hash = hash * 33 + (guchar) word[i];
+
+	return hash;
+}
+
+/* Returns: the slot of the word, or the empty slot where it would go */
+static EnchantSessionSlot *
+enchant_session_find_slot (EnchantSessionSlot * slots, guint n_slots,
+			   const char * const word, size_t len, guint hash)
+{
+	for (guint i = hash & (n_slots - 1); ; i = (i + 1) & (n_slots - 1))
+		{
+			EnchantSessionSlot *slot = &slots[i];
+			if (slot->word == NULL ||
+			    (slot->hash == hash && slot->len == len && memcmp (slot->word, word, len) == 0))
+				return slot;
+		}
+}
+
+static void
+enchant_session_set_word (EnchantSession * session, const char * const word, size_t len,
+			  EnchantSessionWord state)
+{
+	/* keep the table at most three quarters full */
+	if (4 * (session->n_session_words + 1) > 3 * session->n_session_slots)
+		{
+			guint n_slots = session->n_session_slots ? 2 * session->n_session_slots : 16;
+			EnchantSessionSlot *slots = g_new0 (EnchantSessionSlot, n_slots);
+			for (guint i = 0; i < session->n_session_slots; i++)
+				{
+					EnchantSessionSlot *old = &session->session_words[i];
+					if (old->word != NULL)
+						*enchant_session_find_slot (slots, n_slots, old->word, old->len, old->hash) = *old;
+				}
+			g_free (session->session_words);
+			session->session_words = slots;
+			session->n_session_slots = n_slots;
+		}
+
+	guint hash = enchant_session_hash (word, len);
+	EnchantSessionSlot *slot = enchant_session_find_slot (session->session_words, session->n_session_slots,
+							      word, len, hash);
+	if (slot->word == NULL)
+		{
+			if (session->session_strings == NULL)
+				session->session_strings = g_string_chunk_new (1024);
+			slot->word = g_string_chunk_insert_len (session->session_strings, word, len);
+			slot->len = len;
+			slot->hash = hash;
+			session->n_session_words++;
+		}
+	slot->state = state;
+}
+
 static void
 enchant_session_add (EnchantSession * session, const char * const word, size_t len)
 {
-	char* key = g_strndup (word, len);
-	g_hash_table_remove (session->session_exclude, key);
-	g_hash_table_insert (session->session_include, key, GINT_TO_POINTER(TRUE));
+	enchant_session_set_word (session, word, len, ENCHANT_SESSION_INCLUDED);
 }
 
 static void
 enchant_session_remove (EnchantSession * session, const char * const word, size_t len)
 {
-	char* key = g_strndup (word, len);
-	g_hash_table_remove (session->session_include, key);
-	g_hash_table_insert (session->session_exclude, key, GINT_TO_POINTER(TRUE));
+	enchant_session_set_word (session, word, len, ENCHANT_SESSION_EXCLUDED);
+}
+
+/* Returns: whether the word was added to or removed from the session */
+static EnchantSessionWord
+enchant_session_lookup_word (EnchantSession * session, const char * const word, size_t len)
+{
+	if (session->n_session_words == 0)
+		return ENCHANT_SESSION_UNKNOWN;
+
+	EnchantSessionSlot *slot = enchant_session_find_slot (session->session_words, session->n_session_slots,
+							      word, len, enchant_session_hash (word, len));
+	return slot->word != NULL ? slot->state : ENCHANT_SESSION_UNKNOWN;
 }
 
 static void
 enchant_session_add_personal (EnchantSession * session, const char * const word, size_t len)
 {
-	enchant_pwl_add(session->personal, word, len);
+	enchant_pwl_add_many(session->personal, &word, &len, 1, &session->personal_generation);
 }
 
 static void
 enchant_session_remove_personal (EnchantSession * session, const char * const word, size_t len)
 {
-	enchant_pwl_remove(session->personal, word, len);
+	enchant_pwl_remove_many(session->personal, &word, &len, 1, &session->personal_generation);
 }
 
 static void
 enchant_session_add_exclude (EnchantSession * session, const char * const word, size_t len)
 {
-	enchant_pwl_add(session->exclude, word, len);
+	enchant_pwl_add_many(enchant_session_get_exclude (session), &word, &len, 1,
+			     &session->exclude_generation);
 }
 
 static void
 enchant_session_remove_exclude (EnchantSession * session, const char * const word, size_t len)
 {
-	enchant_pwl_remove(session->exclude, word, len);
+	EnchantPWL *exclude = enchant_session_find_exclude (session);
+	if (exclude)
+		enchant_pwl_remove_many(exclude, &word, &len, 1, &session->exclude_generation);
+}
+
+static void
+enchant_session_add_personal_many (EnchantSession * session, const char * const * words,
+				   const size_t * lens, size_t n_words)
+{
+	enchant_pwl_add_many(session->personal, words, lens, n_words, &session->personal_generation);
+	EnchantPWL *exclude = enchant_session_find_exclude (session);
+	if (exclude)
+		enchant_pwl_remove_many(exclude, words, lens, n_words, &session->exclude_generation);
+}
+
+static void
+enchant_session_remove_personal_many (EnchantSession * session, const char * const * words,
+				      const size_t * lens, size_t n_words)
+{
+	enchant_pwl_remove_many(session->personal, words, lens, n_words, &session->personal_generation);
+	enchant_pwl_add_many(enchant_session_get_exclude (session), words, lens, n_words,
+			     &session->exclude_generation);
+}
+
+/* Returns: whether the personal or exclude list changed other than through
+ * the session since it last looked, such as by a reload of its file or
+ * through another dictionary sharing it.  The files are looked at first as
+ * the refresh policy says, so that a cached result is never older than an
+ * uncached one would be */
+static gboolean
+enchant_session_lists_changed (EnchantSession * session)
+{
+	uint64_t personal_generation = enchant_pwl_get_generation (session->personal);
+	EnchantPWL *exclude = enchant_session_find_exclude (session);
+	uint64_t exclude_generation = exclude ? enchant_pwl_get_generation (exclude) : 0;
+	gboolean changed = personal_generation != session->personal_generation ||
+		exclude_generation != session->exclude_generation;
+
+	session->personal_generation = personal_generation;
+	session->exclude_generation = exclude_generation;
+	return changed;
 }
 
-/* a word is excluded if it is in the exclude dictionary or in the session exclude list
- *  AND the word has not been added to the session include list
+/* a word is excluded if it is in the exclude dictionary or was removed from the session
+ *  AND the word has not been added to the session since
  */
 static gboolean
 enchant_session_exclude (EnchantSession * session, const char * const word, size_t len)
 {
-	char * utf = g_strndup (word, len);
-	gboolean result = !g_hash_table_lookup (session->session_include, utf) &&
-		(g_hash_table_lookup (session->session_exclude, utf) ||
-		 enchant_pwl_check (session->exclude, word, len) == 0);
-	g_free (utf);
-
-	return result;
+	switch (enchant_session_lookup_word (session, word, len))
+		{
+		case ENCHANT_SESSION_INCLUDED:
+			return FALSE;
+		case ENCHANT_SESSION_EXCLUDED:
+			return TRUE;
+		default:
+			{
+				EnchantPWL *exclude = enchant_session_find_exclude (session);
+				return exclude && enchant_pwl_check (exclude, word, len) == 0;
+			}
+		}
 }
 
+/* a word is contained if it was added to the session, or is in the personal
+ *  dictionary AND not in the exclude dictionary
+ */
 static gboolean
 enchant_session_contains (EnchantSession * session, const char * const word, size_t len)
 {
-	char * utf = g_strndup (word, len);
-	gboolean result = g_hash_table_lookup (session->session_include, utf) ||
-		(enchant_pwl_check (session->personal, word, len) == 0 &&
-		 (!enchant_pwl_check (session->exclude, word, len)) == 0);
-	g_free (utf);
+	return enchant_session_lookup_word (session, word, len) == ENCHANT_SESSION_INCLUDED ||
+		enchant_pwl_check_with_exclude (session->personal, enchant_session_find_exclude (session),
+						word, len) == 0;
+}
 
-	return result;
+/* Returns: whether the word is excluded or contained, as enchant_session_exclude
+ * and enchant_session_contains tell, looking it up in each table and list once */
+static EnchantSessionWord
+enchant_session_lookup (EnchantSession * session, const char * const word, size_t len)
+{
+	EnchantSessionWord result = enchant_session_lookup_word (session, word, len);
+	if (result != ENCHANT_SESSION_UNKNOWN)
+		return result;
+
+	switch (enchant_pwl_check_with_exclude (session->personal, enchant_session_find_exclude (session),
+						word, len))
+		{
+		case 1:
+			return ENCHANT_SESSION_EXCLUDED;
+		case 0:
+			return ENCHANT_SESSION_INCLUDED;
+		default:
+			return ENCHANT_SESSION_UNKNOWN;
+		}
 }
 
 static void
@@ -385,6 +684,271 @@ enchant_session_clear_error (EnchantSession * session)
 		}
 }
 
+static guint
+enchant_check_entry_hash (gconstpointer entry)
+{
+	return ((const EnchantCheckEntry *) entry)->hash;
+}
+
+static gboolean
+enchant_check_entry_equal (gconstpointer a, gconstpointer b)
+{
+	const EnchantCheckEntry *entry_a = (const EnchantCheckEntry *) a;
+	const EnchantCheckEntry *entry_b = (const EnchantCheckEntry *) b;
+	return entry_a->len == entry_b->len && memcmp (entry_a->word, entry_b->word, entry_a->len) == 0;
+}
+
+static void
+enchant_check_cache_clear (EnchantCheckCache * cache)
+{
+	if (cache->index)
+		g_hash_table_remove_all (cache->index);
+	for (size_t i = 0; i < cache->n_entries; i++)
+		g_free (cache->entries[i].word);
+	cache->n_entries = 0;
+	cache->hand = 0;
+}
+
+static void
+enchant_check_cache_free (EnchantCheckCache * cache)
+{
+	enchant_check_cache_clear (cache);
+	if (cache->index)
+		g_hash_table_destroy (cache->index);
+	g_free (cache->entries);
+	cache->index = NULL;
+	cache->entries = NULL;
+	cache->n_allocated = 0;
+}
+
+/* Returns: the cached result of checking the word, or -1 */
+static int
+enchant_check_cache_lookup (EnchantCheckCache * cache, const char * const word, size_t len, guint hash)
+{
+	EnchantCheckEntry key = { (char *) word, len, hash, 0, FALSE };
+	EnchantCheckEntry *entry = NULL;
+	if (cache->index)
+		entry = (EnchantCheckEntry *) g_hash_table_lookup (cache->index, &key);
+
+	if (entry == NULL)
+		{
+			cache->n_misses++;
+			return -1;
+		}
+
+	cache->n_hits++;
+	entry->referenced = TRUE;
+	return entry->result;
+}
+
+/* The index points into the entries, so it is rebuilt when they move */
+static void
+enchant_check_cache_grow (EnchantCheckCache * cache)
+{
+	cache->n_allocated = MIN (MAX (2 * cache->n_allocated, ENCHANT_CHECK_CACHE_MIN_ENTRIES), cache->size);
+	cache->entries = g_renew (EnchantCheckEntry, cache->entries, cache->n_allocated);
+
+	if (cache->index == NULL)
+		cache->index = g_hash_table_new (enchant_check_entry_hash, enchant_check_entry_equal);
+	else
+		g_hash_table_remove_all (cache->index);
+	for (size_t i = 0; i < cache->n_entries; i++)
+		g_hash_table_insert (cache->index, &cache->entries[i], &cache->entries[i]);
+}
+
+static void
+enchant_check_cache_insert (EnchantCheckCache * cache, const char * const word, size_t len,
+			    guint hash, int result)
+{
+	/* a word may come more than once in one enchant_dict_check_many */
+	EnchantCheckEntry key = { (char *) word, len, hash, 0, FALSE };
+	if (cache->index && g_hash_table_contains (cache->index, &key))
+		return;
+
+	EnchantCheckEntry *entry;
+	if (cache->n_entries < cache->size)
+		{
+			if (cache->n_entries == cache->n_allocated)
+				enchant_check_cache_grow (cache);
+			entry = &cache->entries[cache->n_entries++];
+		}
+	else
+		{
+			while (cache->entries[cache->hand].referenced)
+				{
+					cache->entries[cache->hand].referenced = FALSE;
+					cache->hand = (cache->hand + 1) % cache->n_entries;
+				}
+			entry = &cache->entries[cache->hand];
+			cache->hand = (cache->hand + 1) % cache->n_entries;
+			g_hash_table_remove (cache->index, entry);
+			g_free (entry->word);
+		}
+
+	entry->word = g_strndup (word, len);
+	entry->len = len;
+	entry->hash = hash;
+	entry->result = result;
+	entry->referenced = FALSE;
+	g_hash_table_insert (cache->index, entry, entry);
+}
+
+static guint
+enchant_suggest_entry_hash (gconstpointer entry)
+{
+	return ((const EnchantSuggestEntry *) entry)->hash;
+}
+
+static gboolean
+enchant_suggest_entry_equal (gconstpointer a, gconstpointer b)
+{
+	const EnchantSuggestEntry *entry_a = (const EnchantSuggestEntry *) a;
+	const EnchantSuggestEntry *entry_b = (const EnchantSuggestEntry *) b;
+	return entry_a->len == entry_b->len && memcmp (entry_a->word, entry_b->word, entry_a->len) == 0;
+}
+
+/* Copies a list of strings into one block, the pointers followed by the
+ * strings, which g_free frees at once */
+static char **
+enchant_pack_string_list (char ** suggs, size_t n_suggs)
+{
+	if (suggs == NULL)
+		return NULL;
+
+	size_t n_bytes = (n_suggs + 1) * sizeof (char *);
+	for (size_t i = 0; i < n_suggs; i++)
+		n_bytes += strlen (suggs[i]) + 1;
+
+	char **packed = (char **) g_malloc (n_bytes);
+	char *end = (char *) (packed + n_suggs + 1);
+	for (size_t i = 0; i < n_suggs; i++)
+		{
+			size_t sugg_size = strlen (suggs[i]) + 1;
+			packed[i] = (char *) memcpy (end, suggs[i], sugg_size);
+			end += sugg_size;
+		}
+	packed[n_suggs] = NULL;
+	return packed;
+}
+
+static char **
+enchant_suggest_copy (char ** suggs, size_t n_suggs)
+{
+	if (suggs == NULL)
+		return NULL;
+
+	char **copy = g_new (char *, n_suggs + 1);
+	for (size_t i = 0; i < n_suggs; i++)
+		copy[i] = g_strdup (suggs[i]);
+	copy[n_suggs] = NULL;
+	return copy;
+}
+
+static void
+enchant_suggest_cache_drop (EnchantSuggestCache * cache, EnchantSuggestEntry * entry)
+{
+	g_hash_table_remove (cache->index, entry);
+	g_queue_unlink (&cache->recent, &entry->link);
+	cache->n_bytes -= entry->n_bytes;
+
+	g_free (entry->suggs);
+	g_free (entry->word);
+	g_free (entry);
+}
+
+static void
+enchant_suggest_cache_clear (EnchantSuggestCache * cache)
+{
+	while (cache->recent.tail)
+		enchant_suggest_cache_drop (cache, (EnchantSuggestEntry *) cache->recent.tail->data);
+}
+
+static void
+enchant_suggest_cache_free (EnchantSuggestCache * cache)
+{
+	enchant_suggest_cache_clear (cache);
+	if (cache->index)
+		g_hash_table_destroy (cache->index);
+	cache->index = NULL;
+}
+
+/* Returns: whether there is a list for the word, which is then stored in @out_suggs
+ * as it is cached, for the caller to copy before the cache changes */
+static gboolean
+enchant_suggest_cache_lookup (EnchantSuggestCache * cache, const char * const word, size_t len, guint hash,
+			      char *** out_suggs, size_t * out_n_suggs)
+{
+	EnchantSuggestEntry key = { (char *) word, len, hash, NULL, 0, 0, { NULL, NULL, NULL } };
+	EnchantSuggestEntry *entry = NULL;
+	if (cache->index)
+		entry = (EnchantSuggestEntry *) g_hash_table_lookup (cache->index, &key);
+
+	if (entry == NULL)
+		{
+			cache->n_misses++;
+			return FALSE;
+		}
+
+	cache->n_hits++;
+	g_queue_unlink (&cache->recent, &entry->link);
+	g_queue_push_head_link (&cache->recent, &entry->link);
+
+	*out_suggs = entry->suggs;
+	*out_n_suggs = entry->n_suggs;
+	return TRUE;
+}
+
+static void
+enchant_suggest_cache_insert (EnchantSuggestCache * cache, const char * const word, size_t len, guint hash,
+			      char ** suggs, size_t n_suggs)
+{
+	size_t n_bytes = sizeof (EnchantSuggestEntry) + len + 1 + (n_suggs + 1) * sizeof (char *);
+	for (size_t i = 0; i < n_suggs; i++)
+		n_bytes += strlen (suggs[i]) + 1;
+	if (n_bytes > cache->max_bytes)
+		return;
+
+	while (cache->recent.length >= cache->size || cache->n_bytes + n_bytes > cache->max_bytes)
+		enchant_suggest_cache_drop (cache, (EnchantSuggestEntry *) cache->recent.tail->data);
+
+	if (cache->index == NULL)
+		cache->index = g_hash_table_new (enchant_suggest_entry_hash, enchant_suggest_entry_equal);
+
+	EnchantSuggestEntry *entry = g_new0 (EnchantSuggestEntry, 1);
+	entry->word = g_strndup (word, len);
+	entry->len = len;
+	entry->hash = hash;
+	entry->suggs = enchant_pack_string_list (suggs, n_suggs);
+	entry->n_suggs = n_suggs;
+	entry->n_bytes = n_bytes;
+	entry->link.data = entry;
+
+	g_queue_push_head_link (&cache->recent, &entry->link);
+	g_hash_table_insert (cache->index, entry, entry);
+	cache->n_bytes += n_bytes;
+}
+
+/* Brings the caches up to date with the personal and exclude lists, which
+ * may have changed other than through the dictionary */
+static void
+enchant_dict_follow_lists (EnchantDictPrivateData * dict_private_data)
+{
+	if (enchant_session_lists_changed (dict_private_data->session))
+		{
+			dict_private_data->generation++;
+			enchant_check_cache_clear (&dict_private_data->check_cache);
+		}
+}
+
+/* Forgets what the caches know, after words were added or removed */
+static void
+enchant_dict_words_changed (EnchantDict * dict)
+{
+	EnchantDictPrivateData * dict_private_data = (EnchantDictPrivateData*)dict->enchant_private_data;
+	dict_private_data->generation++;
+	enchant_check_cache_clear (&dict_private_data->check_cache);
+}
+
 /********************************************************************************/
 /********************************************************************************/
 
@@ -415,6 +979,28 @@ enchant_dict_get_error (EnchantDict * dict)
 	return session->error;
 }
 
+static int
+enchant_dict_check_uncached (EnchantDict * dict, EnchantSession * session, const char *const word, size_t len)
+{
+	/* first, see if it's to be excluded, then if it's in our pwl or session */
+	switch (enchant_session_lookup (session, word, len))
+		{
+		case ENCHANT_SESSION_EXCLUDED:
+			return 1;
+		case ENCHANT_SESSION_INCLUDED:
+			return 0;
+		default:
+			break;
+		}
+
+	if (dict->check)
+		return (*dict->check) (dict, word, len);
+	else if (session->is_pwl)
+		return 1;
+
+	return -1;
+}
+
 int
 enchant_dict_check (EnchantDict * dict, const char *const word, ssize_t len)
 {
@@ -427,141 +1013,435 @@ enchant_dict_check (EnchantDict * dict, const char *const word, ssize_t len)
 	g_return_val_if_fail (len, -1);
 	g_return_val_if_fail (g_utf8_validate(word, len, NULL),-1);
 
-	EnchantSession * session = ((EnchantDictPrivateData*)dict->enchant_private_data)->session;
+	EnchantDictPrivateData * dict_private_data = (EnchantDictPrivateData*)dict->enchant_private_data;
+	EnchantSession * session = dict_private_data->session;
+	EnchantCheckCache * cache = &dict_private_data->check_cache;
 	enchant_session_clear_error (session);
 
-	/* first, see if it's to be excluded*/
-	if (enchant_session_exclude (session, word, len))
-		return 1;
+	guint hash = 0;
+	if (cache->size > 0)
+		{
+			enchant_dict_follow_lists (dict_private_data);
 
-	/* then, see if it's in our pwl or session*/
-	if (enchant_session_contains(session, word, len))
-		return 0;
+			hash = enchant_session_hash (word, len);
+			int result = enchant_check_cache_lookup (cache, word, len, hash);
+			if (result >= 0)
+				return result;
+		}
 
-	if (dict->check)
-		return (*dict->check) (dict, word, len);
-	else if (session->is_pwl)
-		return 1;
+	int result = enchant_dict_check_uncached (dict, session, word, len);
+	/* errors are not cached, as they may pass */
+	if (cache->size > 0 && result >= 0)
+		enchant_check_cache_insert (cache, word, len, hash, result);
 
-	return -1;
+	return result;
+}
+
+/* Returns: the byte lengths of @words, given as for enchant_dict_add_many,
+ * or NULL if any of them is not a word */
+static size_t *
+enchant_word_lengths (const char *const *words, const ssize_t *lens, size_t n_words)
+{
+	size_t *word_lens = g_new (size_t, MAX (n_words, 1));
+	for (size_t i = 0; i < n_words; i++)
+		{
+			word_lens[i] = words[i] == NULL ? 0 :
+				lens && lens[i] >= 0 ? (size_t)lens[i] : strlen (words[i]);
+			if (word_lens[i] == 0 || !g_utf8_validate(words[i], word_lens[i], NULL))
+				{
+					g_free (word_lens);
+					return NULL;
+				}
+		}
+	return word_lens;
+}
+
+void
+enchant_dict_check_many (EnchantDict * dict, const char *const *words, const ssize_t *lens,
+			 size_t n_words, int *results)
+{
+	g_return_if_fail (dict);
+	g_return_if_fail (words || n_words == 0);
+	g_return_if_fail (results || n_words == 0);
+
+	for (size_t i = 0; i < n_words; i++)
+		results[i] = -1;
+
+	size_t *word_lens = enchant_word_lengths (words, lens, n_words);
+	g_return_if_fail (word_lens);
+
+	EnchantDictPrivateData * dict_private_data = (EnchantDictPrivateData*)dict->enchant_private_data;
+	EnchantSession * session = dict_private_data->session;
+	EnchantCheckCache * cache = &dict_private_data->check_cache;
+	enchant_session_clear_error (session);
+
+	/* providers built before it have no such member to read */
+	void (*check_batch) (EnchantDict *, const char *const *const, const size_t *, size_t, int *) =
+		dict_private_data->provider_abi_version >= 2 ? dict->check_batch : NULL;
+
+	if (cache->size > 0)
+		enchant_dict_follow_lists (dict_private_data);
+
+	/* answer what the cache and session can, and leave the rest to the provider at once */
+	guint *hashes = g_new0 (guint, MAX (n_words, 1));
+	size_t *pending = g_new (size_t, MAX (n_words, 1));
+	size_t n_pending = 0;
+	for (size_t i = 0; i < n_words; i++)
+		{
+			if (cache->size > 0)
+				{
+					hashes[i] = enchant_session_hash (words[i], word_lens[i]);
+					results[i] = enchant_check_cache_lookup (cache, words[i], word_lens[i], hashes[i]);
+					if (results[i] >= 0)
+						continue;
+				}
+
+			switch (enchant_session_lookup (session, words[i], word_lens[i]))
+				{
+				case ENCHANT_SESSION_EXCLUDED:
+					results[i] = 1;
+					break;
+				case ENCHANT_SESSION_INCLUDED:
+					results[i] = 0;
+					break;
+				default:
+					if (dict->check || check_batch)
+						pending[n_pending++] = i;
+					else if (session->is_pwl)
+						results[i] = 1;
+					break;
+				}
+
+			/* errors are not cached, as they may pass */
+			if (cache->size > 0 && results[i] >= 0)
+				enchant_check_cache_insert (cache, words[i], word_lens[i], hashes[i], results[i]);
+		}
+
+	if (n_pending > 0 && check_batch)
+		{
+			const char **pending_words = g_new (const char *, n_pending);
+			size_t *pending_lens = g_new (size_t, n_pending);
+			int *pending_results = g_new (int, n_pending);
+			for (size_t j = 0; j < n_pending; j++)
+				{
+					pending_words[j] = words[pending[j]];
+					pending_lens[j] = word_lens[pending[j]];
+					pending_results[j] = -1;
+				}
+
+			(*check_batch) (dict, pending_words, pending_lens, n_pending, pending_results);
+			for (size_t j = 0; j < n_pending; j++)
+				results[pending[j]] = pending_results[j];
+
+			g_free (pending_results);
+			g_free (pending_lens);
+			g_free (pending_words);
+		}
+	else
+		for (size_t j = 0; j < n_pending; j++)
+			results[pending[j]] = (*dict->check) (dict, words[pending[j]], word_lens[pending[j]]);
+
+	if (cache->size > 0)
+		for (size_t j = 0; j < n_pending; j++)
+			if (results[pending[j]] >= 0)
+				enchant_check_cache_insert (cache, words[pending[j]], word_lens[pending[j]],
+							    hashes[pending[j]], results[pending[j]]);
+
+	g_free (pending);
+	g_free (hashes);
+	g_free (word_lens);
+}
+
+void
+enchant_dict_set_check_cache_size (EnchantDict * dict, size_t n_entries)
+{
+	g_return_if_fail (dict);
+
+	EnchantDictPrivateData * dict_private_data = (EnchantDictPrivateData*)dict->enchant_private_data;
+	enchant_session_clear_error (dict_private_data->session);
+
+	enchant_check_cache_free (&dict_private_data->check_cache);
+	dict_private_data->check_cache.size = n_entries;
+}
+
+void
+enchant_dict_get_check_cache_stats (EnchantDict * dict, size_t * n_hits, size_t * n_misses)
+{
+	g_return_if_fail (dict);
+
+	EnchantDictPrivateData * dict_private_data = (EnchantDictPrivateData*)dict->enchant_private_data;
+	if (n_hits)
+		*n_hits = dict_private_data->check_cache.n_hits;
+	if (n_misses)
+		*n_misses = dict_private_data->check_cache.n_misses;
 }
 
-/* @suggs must have at least n_suggs + n_new_suggs space allocated
+void
+enchant_dict_set_suggest_cache_size (EnchantDict * dict, size_t n_entries, size_t n_bytes)
+{
+	g_return_if_fail (dict);
+
+	EnchantDictPrivateData * dict_private_data = (EnchantDictPrivateData*)dict->enchant_private_data;
+	enchant_session_clear_error (dict_private_data->session);
+
+	enchant_suggest_cache_free (&dict_private_data->suggest_cache);
+	dict_private_data->suggest_cache.size = n_bytes > 0 ? n_entries : 0;
+	dict_private_data->suggest_cache.max_bytes = n_bytes;
+}
+
+void
+enchant_dict_get_suggest_cache_stats (EnchantDict * dict, size_t * n_hits, size_t * n_misses)
+{
+	g_return_if_fail (dict);
+
+	EnchantDictPrivateData * dict_private_data = (EnchantDictPrivateData*)dict->enchant_private_data;
+	if (n_hits)
+		*n_hits = dict_private_data->suggest_cache.n_hits;
+	if (n_misses)
+		*n_misses = dict_private_data->suggest_cache.n_misses;
+}
+
+/*  The NFD forms of the suggestions merged so far, in an open addressing
+ *  hash table sized at the start for all of them, so that each suggestion
+ *  is normalized once however many there are.
+ */
+typedef struct str_enchant_sugg_set
+{
+	const char **slots;		/* NULL where empty */
+	size_t n_slots;			/* a power of two */
+} EnchantSuggSet;
+
+static void
+enchant_sugg_set_init (EnchantSuggSet * set, size_t n_suggs)
+{
+	set->n_slots = 16;
+	while (set->n_slots < 2 * n_suggs)
+		set->n_slots *= 2;
+	set->slots = g_new0 (const char *, set->n_slots);
+}
+
+/* Returns: FALSE if the normalized suggestion was in the set already */
+static gboolean
+enchant_sugg_set_add (EnchantSuggSet * set, const char * normalized_sugg)
+{
+	size_t mask = set->n_slots - 1;
+	size_t i = g_str_hash (normalized_sugg) & mask;
+	for (; set->slots[i] != NULL; i = (i + 1) & mask)
+		if (strcmp (set->slots[i], normalized_sugg) == 0)
+			return FALSE;
+
+	set->slots[i] = normalized_sugg;
+	return TRUE;
+}
+
+static char **
+enchant_normalize_suggestions (char ** suggs, size_t n_suggs)
+{
+	if (suggs == NULL)
+		return NULL;
+
+	char **normalized_suggs = g_new (char *, n_suggs + 1);
+	for (size_t i = 0; i < n_suggs; i++)
+		normalized_suggs[i] = g_utf8_normalize (suggs[i], -1, G_NORMALIZE_NFD);
+	normalized_suggs[n_suggs] = NULL;
+	return normalized_suggs;
+}
+
+/* Moves the items of @new_suggs not merged already to @suggs, and frees the others;
+ * @new_suggs may be @suggs itself, from n_suggs on
+ *
+ * @suggs must have at least n_suggs + n_new_suggs space allocated
  * @n_suggs is the number if items currently appearing in @suggs
+ * @normalized_new_suggs are @new_suggs in NFD, which @seen keeps while it is used
+ * @seen is the set of the NFD forms of @suggs
  *
  * returns the number of items in @suggs after merge is complete
  */
-static int
-enchant_dict_merge_suggestions(char ** suggs, size_t n_suggs, char ** new_suggs, size_t n_new_suggs)
+static size_t
+enchant_dict_merge_suggestions(char ** suggs, size_t n_suggs, char ** new_suggs,
+			       char ** normalized_new_suggs, size_t n_new_suggs, EnchantSuggSet * seen)
 {
 	for (size_t i = 0; i < n_new_suggs; i++)
 		{
-			char * normalized_new_sugg = g_utf8_normalize (new_suggs[i], -1, G_NORMALIZE_NFD);
-
-			int is_duplicate = 0;
-			for (size_t j = 0; !is_duplicate && j < n_suggs; j++)
-				{
-					char* normalized_sugg = g_utf8_normalize (suggs[j], -1, G_NORMALIZE_NFD);
-					is_duplicate = strcmp (normalized_sugg, normalized_new_sugg) == 0;
-					g_free (normalized_sugg);
-				}
-			g_free (normalized_new_sugg);
-
-			if (!is_duplicate)
-				suggs[n_suggs++] = strdup (new_suggs[i]);
+			char *sugg = new_suggs[i];
+			new_suggs[i] = NULL;
+			if (enchant_sugg_set_add (seen, normalized_new_suggs[i]))
+				suggs[n_suggs++] = sugg;
+			else
+				g_free (sugg);
 		}
 
 	return n_suggs;
 }
 
-static char **
-enchant_dict_get_good_suggestions(EnchantDict * dict, char ** suggs, size_t n_suggs, size_t* out_n_filtered_suggs)
+/* Keeps the items of @suggs which are valid and not excluded, moving them
+ * down over the others, which are freed
+ *
+ * returns the number of items left in @suggs
+ */
+static size_t
+enchant_dict_filter_suggestions(EnchantDict * dict, char ** suggs, size_t n_suggs)
 {
 	EnchantSession * session = ((EnchantDictPrivateData*)dict->enchant_private_data)->session;
 
-	char ** filtered_suggs = g_new0 (char *, n_suggs + 1);
 	size_t n_filtered_suggs = 0;
 	for (size_t i = 0; i < n_suggs; i++)
 		{
-			size_t sugg_len = strlen(suggs[i]);
-
-			if (sugg_len == 0)
-				continue;
+			char *sugg = suggs[i];
+			size_t sugg_len = strlen(sugg);
 
-			if (g_utf8_validate(suggs[i], sugg_len, NULL) &&
-			    !enchant_session_exclude(session, suggs[i], sugg_len))
-				filtered_suggs[n_filtered_suggs++] = strdup (suggs[i]);
+			suggs[i] = NULL;
+			if (sugg_len > 0 && g_utf8_validate(sugg, sugg_len, NULL) &&
+			    !enchant_session_exclude(session, sugg, sugg_len))
+				suggs[n_filtered_suggs++] = sugg;
+			else
+				g_free (sugg);
 		}
 
-	if (out_n_filtered_suggs)
-		*out_n_filtered_suggs = n_filtered_suggs;
-
-	return filtered_suggs;
+	return n_filtered_suggs;
 }
 
-char **
-enchant_dict_suggest (EnchantDict * dict, const char *const word, ssize_t len, size_t * out_n_suggs)
+/* Returns: the suggestions for a word, which are the caller's to free if
+ * @out_owned is set, else the cache's, to be copied before it changes */
+static char **
+_enchant_dict_suggest (EnchantDict * dict, const char *const word, size_t len,
+		       size_t * out_n_suggs, gboolean * out_owned)
 {
-	g_return_val_if_fail (dict, NULL);
-	g_return_val_if_fail (word, NULL);
-
-	if (len < 0)
-		len = strlen (word);
+	size_t n_dict_suggs = 0, n_pwl_suggs = 0;
+	char **dict_suggs = NULL, **pwl_suggs = NULL;
 
-	g_return_val_if_fail (len, NULL);
-	g_return_val_if_fail (g_utf8_validate(word, len, NULL), NULL);
+	EnchantDictPrivateData * dict_private_data = (EnchantDictPrivateData*)dict->enchant_private_data;
+	EnchantSession * session = dict_private_data->session;
+	EnchantSuggestCache * cache = &dict_private_data->suggest_cache;
+	enchant_session_clear_error (session);
 
-	size_t n_dict_suggs = 0, n_pwl_suggs = 0, n_suggsT = 0;
-	char **dict_suggs = NULL, **pwl_suggs = NULL, **suggsT;
+	guint hash = 0;
+	if (cache->size > 0)
+		{
+			enchant_dict_follow_lists (dict_private_data);
+			if (cache->generation != dict_private_data->generation)
+				{
+					enchant_suggest_cache_clear (cache);
+					cache->generation = dict_private_data->generation;
+				}
 
-	EnchantSession * session = ((EnchantDictPrivateData*)dict->enchant_private_data)->session;
-	enchant_session_clear_error (session);
+			hash = enchant_session_hash (word, len);
+			char **suggs;
+			size_t n_suggs;
+			if (enchant_suggest_cache_lookup (cache, word, len, hash, &suggs, &n_suggs))
+				{
+					*out_n_suggs = n_suggs;
+					*out_owned = FALSE;
+					return suggs;
+				}
+		}
 
 	/* Check for suggestions from provider dictionary */
 	if (dict->suggest)
 		{
 			dict_suggs = (*dict->suggest) (dict, word, len, &n_dict_suggs);
 			if (dict_suggs)
-				{
-					suggsT = enchant_dict_get_good_suggestions(dict, dict_suggs, n_dict_suggs, &n_suggsT);
-					enchant_free_string_list (dict_suggs);
-					dict_suggs = suggsT;
-					n_dict_suggs = n_suggsT;
-				}
+				n_dict_suggs = enchant_dict_filter_suggestions(dict, dict_suggs, n_dict_suggs);
+			else
+				n_dict_suggs = 0;
 		}
 
+	/* Normalized once, to bound the personal suggestions and to merge */
+	char **normalized_dict_suggs = enchant_normalize_suggestions (dict_suggs, n_dict_suggs);
+
 	/* Check for suggestions from personal dictionary */
 	if (session->personal)
 		{
-			pwl_suggs = enchant_pwl_suggest(session->personal, word, len, dict_suggs, &n_pwl_suggs);
+			pwl_suggs = enchant_pwl_suggest_normalized(session->personal, word, len,
+								   normalized_dict_suggs, &n_pwl_suggs);
 			if (pwl_suggs)
-				{
-					suggsT = enchant_dict_get_good_suggestions(dict, pwl_suggs, n_pwl_suggs, &n_suggsT);
-					enchant_free_string_list (pwl_suggs);
-					pwl_suggs = suggsT;
-					n_pwl_suggs = n_suggsT;
-				}
+				n_pwl_suggs = enchant_dict_filter_suggestions(dict, pwl_suggs, n_pwl_suggs);
 		}
 
-	/* Clone suggestions, if any */
+	/* Hand the suggestions, if any, over to the caller in the provider's
+	 * list, grown to take the personal ones too */
 	char **suggs = NULL;
 	size_t n_suggs = n_pwl_suggs + n_dict_suggs;
 	if (n_suggs > 0)
 		{
-			suggs = g_new0 (char *, n_suggs + 1);
-			n_suggs = enchant_dict_merge_suggestions(suggs, 0, dict_suggs, n_dict_suggs);
-			n_suggs = enchant_dict_merge_suggestions(suggs, n_suggs, pwl_suggs, n_pwl_suggs);
+			char **normalized_pwl_suggs = enchant_normalize_suggestions (pwl_suggs, n_pwl_suggs);
+			EnchantSuggSet seen;
+			enchant_sugg_set_init (&seen, n_suggs);
+
+			suggs = g_renew (char *, dict_suggs, n_suggs + 1);
+			dict_suggs = NULL;
+			n_suggs = enchant_dict_merge_suggestions(suggs, 0, suggs, normalized_dict_suggs,
+								 n_dict_suggs, &seen);
+			n_suggs = enchant_dict_merge_suggestions(suggs, n_suggs, pwl_suggs, normalized_pwl_suggs,
+								 n_pwl_suggs, &seen);
+			suggs[n_suggs] = NULL;
+
+			g_free (seen.slots);
+			g_strfreev(normalized_pwl_suggs);
 		}
 
+	g_strfreev(normalized_dict_suggs);
 	g_strfreev(dict_suggs);
 	g_strfreev(pwl_suggs);
 
+	/* errors are not cached, as they may pass */
+	if (cache->size > 0 && session->error == NULL)
+		enchant_suggest_cache_insert (cache, word, len, hash, suggs, n_suggs);
+
+	*out_n_suggs = n_suggs;
+	*out_owned = TRUE;
+	return suggs;
+}
+
+char **
+enchant_dict_suggest (EnchantDict * dict, const char *const word, ssize_t len, size_t * out_n_suggs)
+{
+	g_return_val_if_fail (dict, NULL);
+	g_return_val_if_fail (word, NULL);
+
+	if (len < 0)
+		len = strlen (word);
+
+	g_return_val_if_fail (len, NULL);
+	g_return_val_if_fail (g_utf8_validate(word, len, NULL), NULL);
+
+	size_t n_suggs;
+	gboolean owned;
+	char **suggs = _enchant_dict_suggest (dict, word, len, &n_suggs, &owned);
+	if (!owned)
+		suggs = enchant_suggest_copy (suggs, n_suggs);
+
 	if (out_n_suggs)
 		*out_n_suggs = n_suggs;
 
 	return suggs;
 }
 
+char **
+enchant_dict_suggest_packed (EnchantDict * dict, const char *const word, ssize_t len, size_t * out_n_suggs)
+{
+	g_return_val_if_fail (dict, NULL);
+	g_return_val_if_fail (word, NULL);
+
+	if (len < 0)
+		len = strlen (word);
+
+	g_return_val_if_fail (len, NULL);
+	g_return_val_if_fail (g_utf8_validate(word, len, NULL), NULL);
+
+	size_t n_suggs;
+	gboolean owned;
+	char **suggs = _enchant_dict_suggest (dict, word, len, &n_suggs, &owned);
+	char **packed_suggs = enchant_pack_string_list (suggs, n_suggs);
+	if (owned)
+		g_strfreev (suggs);
+
+	if (out_n_suggs)
+		*out_n_suggs = n_suggs;
+
+	return packed_suggs;
+}
+
 void
 enchant_dict_add (EnchantDict * dict, const char *const word, ssize_t len)
 {
@@ -578,11 +1458,32 @@ enchant_dict_add (EnchantDict * dict, const char *const word, ssize_t len)
 	enchant_session_clear_error (session);
 	enchant_session_add_personal (session, word, len);
 	enchant_session_remove_exclude (session, word, len);
+	enchant_dict_words_changed (dict);
 
 	if (dict->add_to_personal)
 		(*dict->add_to_personal) (dict, word, len);
 }
 
+void
+enchant_dict_add_many (EnchantDict * dict, const char *const *words, const ssize_t *lens, size_t n_words)
+{
+	g_return_if_fail (dict);
+	g_return_if_fail (words || n_words == 0);
+
+	size_t *word_lens = enchant_word_lengths (words, lens, n_words);
+	g_return_if_fail (word_lens);
+
+	EnchantSession * session = ((EnchantDictPrivateData*)dict->enchant_private_data)->session;
+	enchant_session_clear_error (session);
+	enchant_session_add_personal_many (session, words, word_lens, n_words);
+	enchant_dict_words_changed (dict);
+
+	if (dict->add_to_personal)
+		for (size_t i = 0; i < n_words; i++)
+			(*dict->add_to_personal) (dict, words[i], word_lens[i]);
+	g_free (word_lens);
+}
+
 void
 enchant_dict_add_to_session (EnchantDict * dict, const char *const word, ssize_t len)
 {
@@ -599,6 +1500,7 @@ enchant_dict_add_to_session (EnchantDict * dict, const char *const word, ssize_t
 	enchant_session_clear_error (session);
 
 	enchant_session_add (session, word, len);
+	enchant_dict_words_changed (dict);
 	if (dict->add_to_session)
 		(*dict->add_to_session) (dict, word, len);
 }
@@ -638,11 +1540,32 @@ enchant_dict_remove (EnchantDict * dict, const char *const word, ssize_t len)
 
 	enchant_session_remove_personal (session, word, len);
 	enchant_session_add_exclude(session, word, len);
+	enchant_dict_words_changed (dict);
 
 	if (dict->add_to_exclude)
 		(*dict->add_to_exclude) (dict, word, len);
 }
 
+void
+enchant_dict_remove_many (EnchantDict * dict, const char *const *words, const ssize_t *lens, size_t n_words)
+{
+	g_return_if_fail (dict);
+	g_return_if_fail (words || n_words == 0);
+
+	size_t *word_lens = enchant_word_lengths (words, lens, n_words);
+	g_return_if_fail (word_lens);
+
+	EnchantSession * session = ((EnchantDictPrivateData*)dict->enchant_private_data)->session;
+	enchant_session_clear_error (session);
+	enchant_session_remove_personal_many (session, words, word_lens, n_words);
+	enchant_dict_words_changed (dict);
+
+	if (dict->add_to_exclude)
+		for (size_t i = 0; i < n_words; i++)
+			(*dict->add_to_exclude) (dict, words[i], word_lens[i]);
+	g_free (word_lens);
+}
+
 void
 enchant_dict_remove_from_session (EnchantDict * dict, const char *const word, ssize_t len)
 {
@@ -659,6 +1582,7 @@ enchant_dict_remove_from_session (EnchantDict * dict, const char *const word, ss
 	enchant_session_clear_error (session);
 
 	enchant_session_remove (session, word, len);
+	enchant_dict_words_changed (dict);
 }
 
 int
@@ -705,7 +1629,11 @@ enchant_dict_store_replacement (EnchantDict * dict,
 
 	/* if it's not implemented, it's not worth emulating */
 	if (dict->store_replacement)
-		(*dict->store_replacement) (dict, mis, mis_len, cor, cor_len);
+		{
+			(*dict->store_replacement) (dict, mis, mis_len, cor, cor_len);
+			/* the provider may suggest the correction differently now */
+			((EnchantDictPrivateData*)dict->enchant_private_data)->generation++;
+		}
 }
 
 void
@@ -718,6 +1646,16 @@ enchant_dict_free_string_list (EnchantDict * dict, char **string_list)
 	g_strfreev(string_list);
 }
 
+void
+enchant_dict_free_packed_string_list (EnchantDict * dict, char **string_list)
+{
+	g_return_if_fail (dict);
+
+	EnchantSession * session = ((EnchantDictPrivateData*)dict->enchant_private_data)->session;
+	enchant_session_clear_error (session);
+	g_free(string_list);
+}
+
 void
 enchant_dict_describe (EnchantDict * dict, EnchantDictDescribeFn fn, void * user_data)
 {
@@ -968,6 +1906,32 @@ enchant_get_ordered_providers (EnchantBroker * broker, const char * const tag)
 	return list;
 }
 
+/* Returns: the ENCHANT_PROVIDER_ABI_VERSION the provider was built against */
+static int
+enchant_provider_get_abi_version (EnchantProvider * provider)
+{
+	EnchantProviderAbiVersionFunc version_func;
+	if (g_module_symbol ((GModule *) provider->enchant_private_data, "enchant_provider_abi_version",
+			     (gpointer *) (&version_func)) && version_func)
+		return version_func ();
+
+	return 1;
+}
+
+static EnchantDictPrivateData *
+enchant_dict_private_data_new (EnchantSession * session, int provider_abi_version)
+{
+	EnchantDictPrivateData *enchant_dict_private_data = g_new0 (EnchantDictPrivateData, 1);
+	enchant_dict_private_data->reference_count = 1;
+	enchant_dict_private_data->session = session;
+	enchant_dict_private_data->provider_abi_version = provider_abi_version;
+	enchant_dict_private_data->check_cache.size = ENCHANT_CHECK_CACHE_DEFAULT_SIZE;
+	enchant_dict_private_data->suggest_cache.size = ENCHANT_SUGGEST_CACHE_DEFAULT_SIZE;
+	enchant_dict_private_data->suggest_cache.max_bytes = ENCHANT_SUGGEST_CACHE_DEFAULT_BYTES;
+
+	return enchant_dict_private_data;
+}
+
 static void
 enchant_dict_destroyed (gpointer data)
 {
@@ -983,6 +1947,8 @@ enchant_dict_destroyed (gpointer data)
 	else if(session->is_pwl)
 		g_free (dict);
 
+	enchant_check_cache_free (&enchant_dict_private_data->check_cache);
+	enchant_suggest_cache_free (&enchant_dict_private_data->suggest_cache);
 	g_free(enchant_dict_private_data);
 
 	enchant_session_destroy (session);
@@ -1059,12 +2025,13 @@ enchant_broker_request_pwl_dict (EnchantBroker * broker, const char *const pwl)
 		}
 
 	session->is_pwl = 1;
+	/* the list may be shared with other brokers, which set its policy */
+	if (broker->pwl_refresh_policy_set)
+		enchant_session_set_pwl_refresh_policy (session, broker->pwl_refresh_policy,
+							broker->pwl_refresh_interval);
 
 	dict = g_new0 (EnchantDict, 1);
-	EnchantDictPrivateData *enchant_dict_private_data = g_new0 (EnchantDictPrivateData, 1);
-	enchant_dict_private_data->reference_count = 1;
-	enchant_dict_private_data->session = session;
-	dict->enchant_private_data = (void *)enchant_dict_private_data;
+	dict->enchant_private_data = (void *)enchant_dict_private_data_new (session, ENCHANT_PROVIDER_ABI_VERSION);
 
 	g_hash_table_insert (broker->dict_map, (gpointer)strdup (pwl), dict);
 
@@ -1095,10 +2062,11 @@ _enchant_broker_request_dict (EnchantBroker * broker, const char *const tag)
 						{
 
 							EnchantSession *session = enchant_session_new (provider, tag);
-							EnchantDictPrivateData *enchant_dict_private_data = g_new0 (EnchantDictPrivateData, 1);
-							enchant_dict_private_data->reference_count = 1;
-							enchant_dict_private_data->session = session;
-							dict->enchant_private_data = (void *)enchant_dict_private_data;
+							if (session && broker->pwl_refresh_policy_set)
+								enchant_session_set_pwl_refresh_policy (session, broker->pwl_refresh_policy,
+													broker->pwl_refresh_interval);
+							dict->enchant_private_data = (void *)enchant_dict_private_data_new (session,
+															    enchant_provider_get_abi_version (provider));
 							g_hash_table_insert (broker->dict_map, (gpointer)strdup (tag), dict);
 							break;
 						}
@@ -1420,6 +2388,32 @@ enchant_broker_set_ordering (EnchantBroker * broker, const char * const tag, con
 		}
 }
 
+void
+enchant_broker_set_pwl_refresh_policy (EnchantBroker * broker, EnchantPWLRefreshPolicy policy,
+				       unsigned int interval_ms)
+{
+	g_return_if_fail (broker);
+	g_return_if_fail (policy == ENCHANT_PWL_REFRESH_ALWAYS ||
+			  policy == ENCHANT_PWL_REFRESH_THROTTLED ||
+			  policy == ENCHANT_PWL_REFRESH_NOTIFY);
+
+	enchant_broker_clear_error (broker);
+
+	broker->pwl_refresh_policy = policy;
+	broker->pwl_refresh_interval = interval_ms;
+	broker->pwl_refresh_policy_set = TRUE;
+
+	GHashTableIter iter;
+	gpointer value;
+	g_hash_table_iter_init (&iter, broker->dict_map);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+		{
+			EnchantSession *session = ((EnchantDictPrivateData*)((EnchantDict*)value)->enchant_private_data)->session;
+			if (session)
+				enchant_session_set_pwl_refresh_policy (session, policy, interval_ms);
+		}
+}
+
 void
 enchant_provider_set_error (EnchantProvider * provider, const char * const err)
 {
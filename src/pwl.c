@@ -34,7 +34,8 @@
  *
  *  Under the hood, a PWL is stored as a Trie.  Checking strings for
  *  correctness and making suggestions is done by traversing the Trie
- *  while allowing a certain number of miss-steps.  Due to the prefix
+ *  in step with a Levenshtein automaton for the target word, which
+ *  tracks how many miss-steps each path needs.  Due to the prefix
  *  compression of the Trie, this allows all strings in the PWL within
  *  a given edit distance of the target word to be enumerated quite
  *  efficiently.
@@ -46,9 +47,6 @@
  *       at the front of the list.  Would need a "soundex" that is
  *       general enough to handle languages other than English.
  *
- *     - iterative deepening to find suggestions, rather than a straight
- *       search to depth three.
- *
  */
 
 #include "config.h"
@@ -60,10 +58,17 @@
 #include <sys/stat.h>
 #include <sys/file.h>
 #include <fcntl.h>
+#include <locale.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_INOTIFY_H
+#include <errno.h>
+#include <sys/inotify.h>
+#endif
 
 #include <glib.h>
 #include <glib/gstdio.h>
 #include "enchant-provider.h"
+#include "stat-time.h"
 #include "unused-parameter.h"
 
 #include "pwl.h"
@@ -71,370 +76,2164 @@
 #define ENCHANT_PWL_MAX_ERRORS 3
 #define ENCHANT_PWL_MAX_SUGGS 15
 
-static const gunichar BOM = 0xfeff;
+/* Limits of the allocation-free edit distance: patterns the bit-parallel
+ * kernel takes (one bit per character), the widest band the fallback for
+ * longer words supports, and its window of decoded characters. */
+#define EDIT_DIST_MAX_PATTERN 64
+#define EDIT_DIST_MAX_BAND 16
+#define EDIT_DIST_RING_SIZE 64
+
+/* A deletion index lists each word under the strings made by deleting up
+ * to ENCHANT_PWL_DELETIONS_MAX characters (two at most) from its first
+ * ENCHANT_PWL_DELETIONS_PREFIX, so it has up to
+ * ENCHANT_PWL_DELETIONS_VARIANTS entries per word.  Lists of at least
+ * ENCHANT_PWL_DELETIONS_THRESHOLD words get one by default. */
+#define ENCHANT_PWL_DELETIONS_MAX 2
+#define ENCHANT_PWL_DELETIONS_PREFIX 7
+#define ENCHANT_PWL_DELETIONS_VARIANTS (1 + 7 + 7 * 6 / 2)
+#define ENCHANT_PWL_DELETIONS_THRESHOLD 50000
+
+/* Longest word, in characters once normalized, that enchant_pwl_check
+ * looks up without allocating memory */
+#define ENCHANT_PWL_CHECK_MAX_CHARS 128
+
+/* Bytes of a file parsed by one worker at a time when loading it */
+#define ENCHANT_PWL_LOAD_CHUNK_SIZE (64 * 1024)
+
+/* A line of the file removing the word which follows this.  It names
+ * its format so that a comment can't be taken for one. */
+#define ENCHANT_PWL_TOMBSTONE "#enchant-remove:"
+#define ENCHANT_PWL_TOMBSTONE_LEN (sizeof (ENCHANT_PWL_TOMBSTONE) - 1)
+
+/* Fewest lines compaction would drop for it to be worth doing, unless
+ * the file is left without words */
+#define ENCHANT_PWL_COMPACT_MIN_LINES 128
+
+/* Largest file compacted as soon as a word is removed from it, which
+ * costs little more than appending and leaves no line for older versions
+ * of enchant, which skip tombstones, to read the word back from */
+#define ENCHANT_PWL_COMPACT_SMALL_SIZE (64 * 1024)
+
+/* Bits of the membership filter per word it is sized for, and bits set
+ * by each word, which make about one lookup in a hundred a false positive */
+#define ENCHANT_PWL_FILTER_BITS_PER_WORD 10
+#define ENCHANT_PWL_FILTER_PROBES 7
+
+/* Fold the case of a character, for case insensitive comparisons */
+static inline gunichar enchant_unichar_fold(gunichar ch)
+{
+	if (ch >= 'a' && ch <= 'z')
+		return ch;
+	if (ch >= 'A' && ch <= 'Z')
+		return ch + ('a' - 'A');
+	return ch < 0x80 ? ch : g_unichar_tolower(ch);
+}
 
 /*  A PWL dictionary is stored as a Trie-like data structure EnchantTrie.
- *  The EnchantTrie datatype is completely recursive - all child nodes
- *  are simply EnchantTrie pointers.  This means that all functions 
- *  that potentially modify a trie need to return the modified trie,
- *  as additional memory may have been allocated.
+ *  All the nodes of a trie live in a single array, and refer to each
+ *  other by index rather than by pointer, so that a trie is made up of
+ *  a handful of large allocations regardless of the number of words in
+ *  it.
  *
- *  The empty trie is simply the null pointer.  If a trie contains
- *  a single string, it is recorded in the "value" attribute and
- *  "subtries" is set to NULL.  When two or more strings are contained,
- *  "value" is NULL and "subtries" is a GHashTable mapping the first
- *  character of each string to the subtrie containing the remainder of
- *  that string.
+ *  The empty trie has no root node.  If a node contains a single
+ *  string, it is recorded in the "value" attribute and the node has no
+ *  edges.  When two or more strings are contained, "value" is unset and
+ *  the node owns a block of edges, sorted by character, mapping the
+ *  first character of each string to the node containing the remainder
+ *  of that string.
  *
  *  All strings stored in the Trie are assumed to be in UTF format.
- *  Branching is done on unicode characters, not individual bytes.
+ *  Branching is done on unicode characters, not individual bytes.  The
+ *  strings themselves are kept in a shared pool and nodes refer to them
+ *  by offset.
  */
+typedef struct str_enchant_trie_node EnchantTrieNode;
+struct str_enchant_trie_node
+{
+	guint32 value;      /* offset in strings of final string found under this node */
+	guint32 edges;      /* offset in edges of this node's children */
+	guint32 n_edges;    /* number of children */
+	guint32 edges_size; /* capacity of the block of edges, 0 if not branching */
+};
+
+typedef struct str_enchant_trie_edge EnchantTrieEdge;
+struct str_enchant_trie_edge
+{
+	gunichar ch;        /* first character of the strings under node */
+	guint32 node;       /* subtrie */
+};
+
+/* Number of free lists for blocks of edges: one for each power of two */
+#define ENCHANT_TRIE_EDGE_CLASSES 32
+
 typedef struct str_enchant_trie EnchantTrie;
 struct str_enchant_trie
 {
-	char* value;           /* final string found under this node */
-	GHashTable* subtries;  /* Maps characters to subtries */
-};
+	EnchantTrieNode *nodes;
+	guint32 n_nodes, nodes_size;
+	guint32 free_nodes;             /* list of unused nodes, linked by n_edges */
+
+	EnchantTrieEdge *edges;
+	guint32 n_edges, edges_size;
+	guint32 free_edges[ENCHANT_TRIE_EDGE_CLASSES]; /* lists of unused blocks, by log2 of capacity */
+
+	char *strings;
+	gsize n_strings, strings_size;
+	gsize strings_garbage;          /* bytes in strings no longer referred to */
+
+	guint32 root;
+	gboolean read_only;             /* arrays point into a compiled index, or are minimized */
+	gboolean minimized;             /* nodes are shared by words; the arrays are owned */
+};
+
+/* Index of no node, edge or string */
+#define ENCHANT_TRIE_NONE G_MAXUINT32
+
+/* Special Trie node indicating the end of a string.  It is always the
+ * first node in a trie, and is reached by the character 0. */
+#define ENCHANT_TRIE_EOS 0
+
+/*  A minimized trie shares the nodes of words with the same endings as
+ *  well as those of words with the same beginnings, making it a minimal
+ *  acyclic automaton, which for a natural language takes a fraction of
+ *  the memory of the trie.  It is built in one pass over sorted words
+ *  (Daciuk et al., "Incremental Construction of Minimal Acyclic
+ *  Finite-State Automata"): the nodes of the path of the last word are
+ *  kept aside while they may still gain edges, and once the next word
+ *  leaves that path, the nodes it left are complete and are replaced by
+ *  an equal node from the trie, if there is one.  Nodes are looked up by
+ *  the hash of their edges in an open-addressed table.
+ *
+ *  A minimized trie has no leaf strings, every word ending with an edge
+ *  to ENCHANT_TRIE_EOS, and is read-only, since changing a node would
+ *  change every word through it; enchant_trie_unshare turns it back into
+ *  an ordinary trie.  Searches only walk down from the root, so they
+ *  work on it as they are.
+ */
+typedef struct str_enchant_trie_minimizer EnchantTrieMinimizer;
+struct str_enchant_trie_minimizer
+{
+	EnchantTrie *trie;
+	guint32 *table;         /* complete nodes by hash of their edges, ENCHANT_TRIE_EOS for none */
+	guint32 table_size;     /* a power of two */
+	guint32 n_table;
+	GArray *path_edges;     /* edges of the nodes on the path of the last word */
+	GArray *path_starts;    /* offset in path_edges of the edges of each of those nodes */
+};
+
+/*  A deletion index finds the words within a few edits of a misspelling
+ *  without walking the trie, with the symmetric deletion method of
+ *  SymSpell: if two strings are within n edits of each other, deleting at
+ *  most n characters from each of them gives a common string, and this
+ *  still holds for their first few characters.  Each word is listed under
+ *  the hash of each string made by deleting characters from the start of
+ *  its case folded form, and the candidates for a misspelling are the
+ *  words listed under the hashes of its own deletions.  Only hashes are
+ *  kept, by bucket: a collision merely adds a candidate, and every
+ *  candidate is checked with edit_dist anyway.
+ *
+ *  The index is built from the trie when first needed and is not updated
+ *  when words are added or removed; suggestions come from the trie while
+ *  it is out of date, until it is worth rebuilding.
+ */
+typedef struct str_enchant_pwl_deletions EnchantPWLDeletions;
+struct str_enchant_pwl_deletions
+{
+	guint32 *buckets;   /* n_buckets + 1 offsets in entries */
+	guint32 n_buckets;  /* a power of two */
+	guint32 *entries;   /* indices in words, by bucket of hash */
+	guint32 n_entries;
+
+	guint32 *words;     /* offsets in strings of each word */
+	guint32 n_words;
+	char *strings;      /* each word, then its case folded form or "" if the same */
+
+	guint32 *seen;      /* query in which each word was last a candidate */
+	guint32 query;
+};
+
+/*  A PWL is fronted by a Bloom filter of the case folded forms of its
+ *  words, as nearly every word checked is in neither the personal nor the
+ *  exclude list: a word whose folded form is not in the filter is not in
+ *  the trie, in any case.  Each word sets ENCHANT_PWL_FILTER_PROBES bits
+ *  in one block of the size of a cache line, chosen by its hash, so that
+ *  a lookup reads a single line.
+ *
+ *  The filter is built from the trie when first needed and updated as
+ *  words are added.  Removed words are left in it, so it is built afresh
+ *  once the words added or removed since outnumber those it was sized for.
+ */
+typedef struct str_enchant_pwl_filter EnchantPWLFilter;
+struct str_enchant_pwl_filter
+{
+	guint64 *blocks;    /* 8 * n_blocks words of bits */
+	guint32 n_blocks;   /* a power of two */
+	guint32 n_changes;  /* words added or removed, counting those it was built with */
+	guint32 capacity;   /* words it is sized for */
+};
+
+struct str_enchant_pwl
+{
+	EnchantTrie* trie;
+	char * filename;
+	time_t file_changed;
+	off_t file_size;               /* bytes of the file read into the trie */
+	ino_t file_ino;
+	dev_t file_dev;
+
+	EnchantPWLRefreshPolicy refresh_policy;
+	gint64 refresh_interval;       /* in microseconds */
+	gint64 last_refresh;           /* monotonic time the file was last looked at */
+	volatile gint file_touched;    /* set by the watcher when the file changes */
+	volatile gint watch;           /* inotify watch of the directory of the file, or -1 */
+	char *watch_name;              /* name of the file in the watched directory */
+	GHashTable *words_in_trie;     /* empty while the trie is read-only */
+	gboolean read_only;            /* the file is never written to */
+	gboolean loaded;               /* the file was looked at, which waits for the first use */
+	guint32 dead_lines;            /* lines read which compaction would drop */
+	guint64 generation;            /* changes whenever the words do, never 0 */
+
+	char *shared_path;             /* canonical path it is shared under, or NULL */
+	guint ref_count;               /* users of a shared PWL */
+	GMutex lock;                   /* held while a shared PWL is in use */
+
+	/* Case folded forms of the words, for suggestions, with the words
+	 * that fold to each of them as a GSList, unless the form only stands
+	 * for itself; NULL until first needed */
+	EnchantTrie *folded_trie;
+	GHashTable *folded_words;
+
+	size_t visited_nodes;          /* work done by suggestion searches so far */
+	EnchantPWLSuggestIndex suggest_index;
+	EnchantPWLDeletions *deletions;/* deletion index, or NULL */
+	gboolean deletions_stale;      /* words changed since it was built */
+	size_t stale_visited_nodes;    /* visited_nodes when it went out of date */
+
+	EnchantPWLFilter *filter;      /* NULL until first needed */
+	size_t filter_lookups;         /* words looked up in the trie or the filter */
+	size_t filter_rejected;        /* lookups the filter answered */
+	size_t filter_false_positives; /* lookups it let through for words not in the trie */
+
+	gboolean compiled_index;       /* an index is kept next to the file */
+	GMappedFile *index;            /* compiled form of filename, or NULL */
+	guint32 n_index_words;         /* words in the read-only trie */
+	const guint32 *originals;      /* sorted offsets in originals_strings */
+	guint32 n_originals;
+	const char *originals_strings; /* pairs of normalized and original words */
+	gpointer originals_block;      /* memory of the originals of a minimized trie */
+};
+
+/*  A PWL opened read-only keeps its words in a minimized trie rather than
+ *  a trie, with no words_in_trie: the rare words whose original spelling
+ *  is not their normalized form are listed aside, as in a compiled index.
+ *  Words added or removed while it is open are only kept in memory, in an
+ *  ordinary trie.
+ */
+typedef struct str_enchant_pwl_entry EnchantPWLEntry;
+struct str_enchant_pwl_entry
+{
+	char *word;                    /* normalized */
+	char *original;                /* as read, or NULL if normalized */
+	guint32 line;                  /* order read in */
+	gboolean removed;              /* read from a tombstone */
+};
+
+/*  A file is loaded by mapping it and splitting it into chunks of whole
+ *  lines, which worker threads split into lines, validate and normalize
+ *  in parallel, taking the next chunk as they finish one.  The words are
+ *  then added to the trie in order, or sorted into a minimized trie.
+ */
+typedef struct str_enchant_pwl_chunk EnchantPWLChunk;
+struct str_enchant_pwl_chunk
+{
+	const char *start, *end;
+	GArray *entries;               /* EnchantPWLEntry of the words, by line */
+	GArray *bad_lines;             /* lines which are not valid UTF-8, as guint32 */
+	guint32 n_lines;
+};
+
+typedef struct str_enchant_pwl_loader EnchantPWLLoader;
+struct str_enchant_pwl_loader
+{
+	EnchantPWLChunk *chunks;
+	guint n_chunks;
+	volatile gint next_chunk;      /* first chunk no worker has taken */
+};
+
+/*  A compiled PWL index is written next to the text file (as
+ *  "<filename>.idx") whenever the text file has been parsed, for the
+ *  lists which asked for one with enchant_pwl_set_compiled_index, and is
+ *  mapped read-only in place of parsing the text file as long as its
+ *  header matches the modification time, to the nanosecond, size and
+ *  inode of the text file.
+ *  Processes sharing a word list thereby share its trie in the page
+ *  cache.
+ *
+ *  The index consists of the header, followed by the nodes, edges and
+ *  strings of the trie exactly as they are laid out in memory.  All of
+ *  them are made of fixed-width fields aligned to their size, so only
+ *  the byte order differs between hosts; the header records it, and an
+ *  index written in the other one is rebuilt.  The trie only holds
+ *  normalized words, so words which are not stored normalized in the
+ *  text file are listed after the strings of the trie, as pairs of
+ *  normalized and original word, sorted by normalized word.
+ *
+ *  An index is never modified: adding or removing a word copies the
+ *  trie out of the index first.  Since it may be damaged, every offset
+ *  in it is checked when it is mapped, and the text file is parsed
+ *  instead unless they all hold.
+ */
+#define ENCHANT_PWL_INDEX_MAGIC "EnchPWL"
+#define ENCHANT_PWL_INDEX_VERSION 6
+/* Reads back as another number on a host of the other byte order */
+#define ENCHANT_PWL_INDEX_BYTE_ORDER 0x01020304
+
+/* The 64-bit fields come first, so that none needs padding before it */
+typedef struct str_enchant_pwl_index_header EnchantPWLIndexHeader;
+struct str_enchant_pwl_index_header
+{
+	char magic[8];
+	guint32 version;
+	guint32 byte_order;            /* ENCHANT_PWL_INDEX_BYTE_ORDER */
+	gint64 source_mtime;
+	gint64 source_mtime_nsec;
+	guint64 source_size;
+	guint64 source_ino;
+	guint64 n_strings;
+	guint64 originals_size;
+	guint32 root;
+	guint32 n_nodes;
+	guint32 free_nodes;
+	guint32 n_edges;
+	guint32 free_edges[ENCHANT_TRIE_EDGE_CLASSES];
+	guint32 n_originals;
+	guint32 n_words;
+	guint32 n_dead_lines;
+	guint32 padding;               /* to a multiple of 8 bytes, 0 */
+};
+G_STATIC_ASSERT (sizeof (EnchantPWLIndexHeader) == 96 + 4 * ENCHANT_TRIE_EDGE_CLASSES);
+
+/* mode for searching trie: case_insensitive folds the case of the word,
+ * which is then searched for in a trie of case folded words */
+typedef enum enum_matcher_mode EnchantTrieMatcherMode;
+enum enum_matcher_mode
+{
+	case_sensitive,
+	case_insensitive
+};
+
+/*  The EnchantTrieMatcher structure maintains the state necessary to
+ *  search for matching strings within an EnchantTrie.  It includes a
+ *  callback function which will be called with each matching string
+ *  as it is found.  The arguments to this function are:
+ *
+ *      - a freshly-allocated copy of the matching string, which must
+ *        be freed by external code
+ *      - the EnchantTrieMatcher object, giving the context of the match
+ *        (e.g. number of errors)
+ *
+ *  The search intersects the trie with a Levenshtein automaton for the
+ *  word.  The state of the automaton after reading a path is one row of
+ *  the edit distance table between the path and the word, restricted to
+ *  the band of the word within band errors of the diagonal: entry d of the
+ *  row for a path of j characters is the distance to the first
+ *  j + d - band characters of the word, capped at band + 1.  Reading a
+ *  character of the trie computes the next row from the last two, so each
+ *  node is visited once, and a subtrie is skipped as soon as every entry of
+ *  its row is over max_errors.
+ */
+typedef struct str_enchant_trie_matcher EnchantTrieMatcher;
+struct str_enchant_trie_matcher
+{
+	int num_errors;		/* Num errors of the match being reported */
+	int max_errors;		/* Max errors before search should terminate */
+	int band;		/* max_errors when the search started, fixing the width of rows */
+	size_t visited_nodes;	/* trie nodes and leaf characters read so far */
+
+	gunichar* word;		/* Word being searched for */
+	glong word_len;		/* Its length in characters */
+
+	char* path;		    /* Path taken through the trie so far */
+	ssize_t path_len;	/* Length of allocated path string */
+	ssize_t path_pos;	/* Current end pos of path string */
+
+	EnchantTrieMatcherMode mode;
+
+	void (*cbfunc)(char*,EnchantTrieMatcher*); /* callback func */
+	void* cbdata;		/* Private data for use by callback func */
+};
+
+/*  The trie is walked depth first with an explicit stack of
+ *  EnchantTrieFrames, one for each level of the path.  The rows of the
+ *  automaton are kept alongside, in a separate array.
+ */
+typedef struct str_enchant_trie_frame EnchantTrieFrame;
+struct str_enchant_trie_frame
+{
+	guint32 node;
+	guint32 next_edge;	/* how many of the node's edges have been followed */
+	guint32 first_edge;	/* index of the edge to follow first, or ENCHANT_TRIE_NONE */
+	gunichar ch;		/* character read to get here, as compared with the word */
+	int row_min;		/* smallest entry of this level's row */
+	ssize_t path_pos;	/* end of the path at this level */
+};
+
+/*  To allow the list of suggestions to be built up an item at a time,
+ *  its state is maintained in an EnchantSuggList object.
+ */
+typedef struct str_enchant_sugg_list
+{
+	char** suggs;
+	int* sugg_errs;
+	size_t n_suggs;
+	GHashTable *folded_words; /* to find the words a match in the folded trie stands for */
+} EnchantSuggList;
+
+/*  A word checked is looked up in both the personal and the exclude list
+ *  of a dictionary, so the forms of it enchant_pwl_check looks for (the
+ *  word and, for a word in title case or all caps, its lower and title
+ *  case forms) are normalized and hashed once for both.
+ */
+typedef struct str_enchant_pwl_lookup
+{
+	const char *word;
+	size_t len;
+	int n_forms;           /* -1 if the forms are to be made by allocating them */
+	char forms[3][ENCHANT_PWL_CHECK_MAX_CHARS * 6 + 1];
+	guint64 hashes[3];     /* filter hash of each form */
+} EnchantPWLLookup;
+
+/*
+ *   Function Prototypes
+ */
+
+static gboolean enchant_pwl_add_to_trie(EnchantPWL *pwl,
+					const char *const word, size_t len);
+static gboolean enchant_pwl_add_normalized(EnchantPWL *pwl, char *normalized_word, char *word);
+static gboolean enchant_pwl_remove_normalized(EnchantPWL *pwl, const char *normalized_word);
+static int enchant_pwl_contains(EnchantPWL *pwl, const char *const word, size_t len);
+static void enchant_pwl_refresh_from_file(EnchantPWL* pwl);
+static void enchant_pwl_refresh_if_due(EnchantPWL* pwl);
+static gboolean enchant_pwl_load_index(EnchantPWL* pwl, const GStatBuf *stats);
+static void enchant_pwl_save_index(EnchantPWL* pwl, const GStatBuf *stats);
+static void enchant_pwl_unshare_index(EnchantPWL* pwl);
+static void enchant_pwl_drop_index(EnchantPWL* pwl);
+static void enchant_pwl_load_lines(EnchantPWL* pwl, const char *contents, gsize offset, gsize length);
+static void enchant_pwl_load_minimized(EnchantPWL* pwl, GArray *entries);
+static const char* enchant_pwl_lookup_original(EnchantPWL* pwl, const char *normalized_word);
+static void enchant_pwl_free_folded(EnchantPWL *pwl);
+static void enchant_pwl_filter_free(EnchantPWL *pwl);
+static void enchant_pwl_suggest_cb(char* match,EnchantTrieMatcher* matcher);
+static void enchant_pwl_suggest_folded_cb(char* match,EnchantTrieMatcher* matcher);
+static char** enchant_pwl_suggest_within(EnchantPWL *pwl, const char *const word,
+					 size_t len, int max_dist, size_t* out_n_suggs);
+static EnchantTrie* enchant_trie_new(void);
+static void enchant_trie_free(EnchantTrie* trie);
+static void enchant_trie_clear(EnchantTrie* trie);
+static void enchant_trie_unshare(EnchantTrie* trie);
+static void enchant_trie_build_minimized(EnchantTrie* trie, char **words, guint32 n_words);
+static void enchant_trie_insert(EnchantTrie* trie,const char *const word);
+static void enchant_trie_remove(EnchantTrie* trie,const char *const word);
+static gboolean enchant_trie_contains(const EnchantTrie* trie, const char *word);
+static void enchant_trie_foreach_word(EnchantTrie* trie,
+				      void (*func)(const char *word, gpointer data), gpointer data);
+static EnchantPWLDeletions* enchant_pwl_deletions_new(EnchantTrie* trie);
+static void enchant_pwl_deletions_free(EnchantPWLDeletions* deletions);
+static void enchant_pwl_deletions_find_matches(EnchantPWLDeletions* deletions,
+					       EnchantTrieMatcher *matcher);
+static void enchant_trie_find_matches(EnchantTrie* trie,EnchantTrieMatcher *matcher);
+static EnchantTrieMatcher* enchant_trie_matcher_init(const char* const word, size_t len,
+				int maxerrs,
+				EnchantTrieMatcherMode mode,
+				void(*cbfunc)(char*,EnchantTrieMatcher*),
+				void* cbdata);
+static void enchant_trie_matcher_free(EnchantTrieMatcher* matcher);
+static void enchant_trie_matcher_pushpath(EnchantTrieMatcher* matcher,const char* newchars,ssize_t len);
+static int enchant_trie_matcher_pushchar(EnchantTrieMatcher* matcher,gunichar ch);
+
+static int edit_dist(const char* word1, const char* word2, int max_dist);
+
+/*  A PWL file is a journal: a word is added by appending a line with
+ *  the word, and removed by appending a tombstone, a line with the word
+ *  after ENCHANT_PWL_TOMBSTONE, which older versions of enchant skip as
+ *  a comment.  The lines are applied in order when the file is read.
+ *
+ *  Once the lines which no longer add anything (tombstones, the words
+ *  they removed and words listed again) outnumber the words, and there
+ *  are enough of them or no word is left, the file is compacted: the
+ *  other lines are written to a temporary file which is then renamed
+ *  over it.  A small file is compacted as soon as a word is removed, so
+ *  that only in a large one can older versions of enchant, which read
+ *  past the tombstones, still find removed words.
+ *
+ *  Writers hold an exclusive lock on the file and readers a shared one,
+ *  so that no line is read half written, and a writer which finds that
+ *  the file was replaced while it waited for the lock opens the new one.
+ */
+#define enchant_lock_file(f) flock (fileno (f), LOCK_EX)
+#define enchant_lock_file_shared(f) flock (fileno (f), LOCK_SH)
+#define enchant_unlock_file(f) flock (fileno (f), LOCK_UN)
+
+/**
+ * enchant_pwl_init
+ *
+ * Returns: a new PWL object used to store/check/suggest words.
+ */
+EnchantPWL* enchant_pwl_init(void)
+{
+	EnchantPWL *pwl = g_new0(EnchantPWL, 1);
+	pwl->trie = enchant_trie_new();
+	pwl->watch = -1;
+	pwl->words_in_trie = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	pwl->generation = 1;
+
+	return pwl;
+}
+
+/**
+ * enchant_pwl_init_with_file
+ *
+ * The file is only read when its words are first needed, so that lists
+ * which are never used cost nothing but opening the file here.
+ *
+ * Returns: a new PWL object used to store/check/suggest words,
+ * opened read-only if the file cannot be written to,
+ * or NULL if the file cannot be opened or created
+ */ 
+EnchantPWL* enchant_pwl_init_with_file(const char * file)
+{
+	g_return_val_if_fail (file != NULL, NULL);
+
+	FILE* fd = g_fopen(file, "a+");
+	if(fd == NULL)
+		return enchant_pwl_init_with_file_read_only(file);
+	fclose(fd);
+	EnchantPWL *pwl = enchant_pwl_init();
+	pwl->filename = g_strdup(file);
+	pwl->file_changed = 0;
+
+	return pwl;
+}
+
+/**
+ * enchant_pwl_init_with_file_read_only
+ *
+ * Returns: a new PWL object used to check/suggest the words of a file
+ * which is never written to, or NULL if the file cannot be opened
+ */
+EnchantPWL* enchant_pwl_init_with_file_read_only(const char * file)
+{
+	g_return_val_if_fail (file != NULL, NULL);
+
+	FILE* fd = g_fopen(file, "r");
+	if(fd == NULL)
+		return NULL;
+	fclose(fd);
+	EnchantPWL *pwl = enchant_pwl_init();
+	pwl->filename = g_strdup(file);
+	pwl->read_only = TRUE;
+
+	return pwl;
+}
+
+/*  PWLs opened with enchant_pwl_init_with_file_shared are registered by
+ *  the canonical path of their file, so that all the dictionaries of all
+ *  the brokers of a process using a file share one copy of its words, read
+ *  once.  As brokers may be used from different threads, a shared PWL is
+ *  locked by each call using it, and it is freed with its last user.
+ */
+G_LOCK_DEFINE_STATIC (registry);
+static GHashTable *registry = NULL;
+
+/**
+ * enchant_pwl_init_with_file_shared
+ *
+ * Returns: the PWL of the file shared by the process, opened as by
+ * enchant_pwl_init_with_file if it is not open already, or NULL if the
+ * file cannot be opened or created. Free it with enchant_pwl_free.
+ */
+EnchantPWL* enchant_pwl_init_with_file_shared(const char * file)
+{
+	g_return_val_if_fail (file != NULL, NULL);
+
+	char *path = realpath(file, NULL);
+	if (path == NULL) {
+		/* it has no canonical path until it exists */
+		FILE* fd = g_fopen(file, "a+");
+		if (fd != NULL)
+			fclose(fd);
+		path = realpath(file, NULL);
+		if (path == NULL)
+			return NULL;
+	}
+
+	G_LOCK (registry);
+	if (registry == NULL)
+		registry = g_hash_table_new (g_str_hash, g_str_equal);
+
+	EnchantPWL *pwl = g_hash_table_lookup (registry, path);
+	if (pwl != NULL)
+		pwl->ref_count++;
+	else {
+		/* Registered while holding the lock, so that two threads opening
+		 * the same file get the same PWL.  Its words are read on its first
+		 * use, under its own lock, so that only the first user reads them */
+		pwl = enchant_pwl_init_with_file(file);
+		if (pwl != NULL) {
+			pwl->shared_path = g_strdup(path);
+			pwl->ref_count = 1;
+			g_mutex_init(&pwl->lock);
+			g_hash_table_insert (registry, pwl->shared_path, pwl);
+		}
+	}
+	G_UNLOCK (registry);
+
+	free(path);
+	return pwl;
+}
+
+static void enchant_pwl_lock(EnchantPWL *pwl)
+{
+	if (pwl->shared_path != NULL)
+		g_mutex_lock(&pwl->lock);
+}
+
+static void enchant_pwl_unlock(EnchantPWL *pwl)
+{
+	if (pwl->shared_path != NULL)
+		g_mutex_unlock(&pwl->lock);
+}
+
+static void enchant_pwl_refresh_from_file(EnchantPWL* pwl)
+{
+	pwl->loaded = TRUE;
+
+	GStatBuf stats;
+	if(!pwl->filename ||
+	   g_stat(pwl->filename, &stats) != 0 || /* presumably I won't be able to open the file either */
+	   (pwl->file_changed == stats.st_mtime && pwl->file_size == stats.st_size &&
+	    pwl->file_ino == stats.st_ino && pwl->file_dev == stats.st_dev)) /* nothing changed since last read, nor was it replaced */
+		return;
+
+	/* If the file only grew since it was last read, as when another
+	 * process adds a word, just read the new lines, unless the words are
+	 * in a minimized trie, which is rebuilt */
+	FILE *f = NULL;
+	GStatBuf locked;
+	if (!pwl->read_only && pwl->file_changed != 0 && pwl->file_size > 0 &&
+	    stats.st_size > pwl->file_size &&
+	    stats.st_ino == pwl->file_ino && stats.st_dev == pwl->file_dev &&
+	    (f = g_fopen(pwl->filename, "r")) != NULL) {
+		enchant_lock_file_shared (f);
+		/* the file must not have been compacted meanwhile, and the
+		 * last line read must have been complete */
+		if (fstat(fileno(f), &locked) != 0 ||
+		    locked.st_ino != pwl->file_ino || locked.st_dev != pwl->file_dev ||
+		    fseek(f, (long)pwl->file_size - 1, SEEK_SET) != 0 || getc(f) != '\n') {
+			enchant_unlock_file (f);
+			fclose (f);
+			f = NULL;
+		}
+	}
+	off_t offset = f ? pwl->file_size : 0;
+	if (f)
+		stats = locked;
+
+	if (f == NULL) {
+		enchant_trie_clear(pwl->trie);
+		g_hash_table_destroy (pwl->words_in_trie);
+		pwl->words_in_trie = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		enchant_pwl_deletions_free(pwl->deletions);
+		pwl->deletions = NULL;
+		enchant_pwl_free_folded(pwl);
+		enchant_pwl_filter_free(pwl);
+		enchant_pwl_drop_index(pwl);
+		pwl->dead_lines = 0;
+		pwl->generation++;
+
+		/* Most exclude lists are empty: there is nothing to read */
+		if (stats.st_size == 0) {
+			pwl->file_changed = stats.st_mtime;
+			pwl->file_size = 0;
+			pwl->file_ino = stats.st_ino;
+			pwl->file_dev = stats.st_dev;
+			return;
+		}
+
+		/* The directory of a read-only file is seldom writable, and the
+		 * minimized trie is smaller than the index anyway */
+		if (!pwl->read_only && enchant_pwl_load_index(pwl, &stats)) {
+			pwl->file_changed = stats.st_mtime;
+			pwl->file_size = stats.st_size;
+			pwl->file_ino = stats.st_ino;
+			pwl->file_dev = stats.st_dev;
+			return;
+		}
+
+		f = g_fopen(pwl->filename, "r");
+		if (!f) 
+			return;
+
+		enchant_lock_file_shared (f);
+		/* the file read is the one locked, even if it was just replaced */
+		if (fstat(fileno(f), &locked) == 0)
+			stats = locked;
+	}
+
+	pwl->file_changed = stats.st_mtime;
+	pwl->file_ino = stats.st_ino;
+	pwl->file_dev = stats.st_dev;
+
+	GMappedFile *mapped = g_mapped_file_new_from_fd(fileno(f), FALSE, NULL);
+	if (mapped) {
+		gsize length = g_mapped_file_get_length(mapped);
+		if ((gsize)offset <= length) {
+			enchant_pwl_load_lines(pwl, g_mapped_file_get_contents(mapped), offset, length);
+			pwl->file_size = length;
+		}
+		g_mapped_file_unref(mapped);
+	}
+	
+	enchant_unlock_file (f);
+	fclose (f);
+
+	if (offset == 0 && !pwl->read_only)
+		enchant_pwl_save_index(pwl, &stats);
+}
+
+/* Split a chunk into lines, and validate and normalize those which hold a
+ * word or a tombstone, ignoring trailing white space */
+static void enchant_pwl_parse_chunk(EnchantPWLChunk *chunk)
+{
+	chunk->entries = g_array_new(FALSE, FALSE, sizeof(EnchantPWLEntry));
+	chunk->bad_lines = g_array_new(FALSE, FALSE, sizeof(guint32));
+	chunk->n_lines = 0;
+
+	for (const char *line = chunk->start; line < chunk->end; chunk->n_lines++) {
+		const char *eol = memchr(line, '\n', chunk->end - line);
+		const char *next_line = eol ? eol + 1 : chunk->end;
+		if (eol == NULL)
+			eol = chunk->end;
+		while (eol > line && g_ascii_isspace(eol[-1]))
+			eol--;
+
+		gsize len = eol - line;
+		if (len > ENCHANT_PWL_TOMBSTONE_LEN &&
+		    memcmp(line, ENCHANT_PWL_TOMBSTONE, ENCHANT_PWL_TOMBSTONE_LEN) == 0) {
+			/* a tombstone which is not UTF-8 can only be a comment */
+			const char *word = line + ENCHANT_PWL_TOMBSTONE_LEN;
+			if (g_utf8_validate(word, eol - word, NULL)) {
+				EnchantPWLEntry entry;
+				entry.word = g_utf8_normalize(word, eol - word, G_NORMALIZE_NFD);
+				entry.original = NULL;
+				entry.line = chunk->n_lines;
+				entry.removed = TRUE;
+				g_array_append_val(chunk->entries, entry);
+			}
+		}
+		else if (len > 0 && line[0] != '#') {
+			if (!g_utf8_validate(line, len, NULL))
+				g_array_append_val(chunk->bad_lines, chunk->n_lines);
+			else {
+				EnchantPWLEntry entry;
+				entry.word = g_utf8_normalize(line, len, G_NORMALIZE_NFD);
+				entry.original = strlen(entry.word) != len || memcmp(entry.word, line, len) != 0 ?
+					g_strndup(line, len) : NULL;
+				entry.line = chunk->n_lines;
+				entry.removed = FALSE;
+				g_array_append_val(chunk->entries, entry);
+			}
+		}
+		line = next_line;
+	}
+}
+
+static gpointer enchant_pwl_load_chunks(gpointer data)
+{
+	EnchantPWLLoader *loader = data;
+	for (;;) {
+		guint chunk = (guint)g_atomic_int_add(&loader->next_chunk, 1);
+		if (chunk >= loader->n_chunks)
+			break;
+		enchant_pwl_parse_chunk(&loader->chunks[chunk]);
+	}
+	return NULL;
+}
+
+/* Returns: the number of lines before offset in contents */
+static size_t enchant_pwl_lines_before(const char *contents, gsize offset)
+{
+	size_t lines = 0;
+	for (const char *p = contents; (p = memchr(p, '\n', contents + offset - p)) != NULL; p++)
+		lines++;
+	return lines;
+}
+
+/* Add the words of the lines of contents from offset on */
+static void enchant_pwl_load_lines(EnchantPWL* pwl, const char *contents, gsize offset, gsize length)
+{
+	if (offset == length)
+		return;
+
+	const char *start = contents + offset, *end = contents + length;
+	if (offset == 0 && length >= 3 && memcmp(start, "\xef\xbb\xbf", 3) == 0) /* BOM */
+		start += 3;
+
+	EnchantPWLLoader loader;
+	loader.n_chunks = (end - start) / ENCHANT_PWL_LOAD_CHUNK_SIZE + 1;
+	loader.chunks = g_new(EnchantPWLChunk, loader.n_chunks);
+	loader.next_chunk = 0;
+	for (guint i = 0; i < loader.n_chunks; i++) {
+		const char *chunk_end = i + 1 < loader.n_chunks ?
+			start + (end - start) / loader.n_chunks * (i + 1) : end;
+		if (i > 0)
+			chunk_end = MAX (chunk_end, loader.chunks[i - 1].end);
+		if (chunk_end < end) {
+			const char *eol = memchr(chunk_end, '\n', end - chunk_end);
+			chunk_end = eol ? eol + 1 : end;
+		}
+		loader.chunks[i].start = i > 0 ? loader.chunks[i - 1].end : start;
+		loader.chunks[i].end = chunk_end;
+	}
+
+	guint n_threads = MIN (loader.n_chunks, g_get_num_processors());
+	GThread **threads = g_new(GThread *, MAX (n_threads, 1));
+	for (guint i = 1; i < n_threads; i++)
+		threads[i] = g_thread_new("enchant-pwl-loader", enchant_pwl_load_chunks, &loader);
+	enchant_pwl_load_chunks(&loader);
+	for (guint i = 1; i < n_threads; i++)
+		g_thread_join(threads[i]);
+	g_free(threads);
+
+	size_t lines_before = offset == 0 ? 0 : (size_t)-1;
+	guint32 line = 0;
+	GArray *entries = NULL;
+	for (guint i = 0; i < loader.n_chunks; i++) {
+		EnchantPWLChunk *chunk = &loader.chunks[i];
+		for (guint j = 0; j < chunk->bad_lines->len; j++) {
+			if (lines_before == (size_t)-1)
+				lines_before = enchant_pwl_lines_before(contents, offset);
+			g_warning ("Bad UTF-8 sequence in %s at line:%zu\n", pwl->filename,
+				   lines_before + line + g_array_index(chunk->bad_lines, guint32, j) + 1);
+		}
+		g_array_free(chunk->bad_lines, TRUE);
+
+		EnchantPWLEntry *e = (EnchantPWLEntry *)(void *)chunk->entries->data;
+		for (guint j = 0; j < chunk->entries->len; j++) {
+			e[j].line += line;
+			if (pwl->read_only)
+				continue;
+			if (e[j].removed) {
+				/* the tombstone and the line of the word, if there was one;
+				 * compaction keeps a tombstone which removed nothing */
+				if (enchant_pwl_remove_normalized(pwl, e[j].word))
+					pwl->dead_lines += 2;
+				g_free(e[j].word);
+			}
+			else if (!enchant_pwl_add_normalized(pwl, e[j].word,
+							     e[j].original ? e[j].original : g_strdup(e[j].word)))
+				pwl->dead_lines++;
+		}
+		line += chunk->n_lines;
+
+		if (!pwl->read_only)
+			g_array_free(chunk->entries, TRUE);
+		else if (entries == NULL)
+			entries = chunk->entries;
+		else {
+			g_array_append_vals(entries, chunk->entries->data, chunk->entries->len);
+			g_array_free(chunk->entries, TRUE);
+		}
+	}
+	g_free(loader.chunks);
+
+	if (entries)
+		enchant_pwl_load_minimized(pwl, entries);
+}
+
+static char* enchant_pwl_index_filename(EnchantPWL* pwl)
+{
+	return g_strconcat(pwl->filename, ".idx", NULL);
+}
+
+/* Returns: whether every node, edge and string offset of a trie mapped
+ * from an index lies within its arrays, and its nodes form a tree, so
+ * that a damaged index cannot be read out of bounds or walked forever */
+static gboolean enchant_pwl_index_trie_is_valid(const EnchantPWLIndexHeader *header,
+						const EnchantTrieNode *nodes,
+						const EnchantTrieEdge *edges,
+						const char *strings)
+{
+	/* The end-of-string node has neither value nor edges */
+	const EnchantTrieNode *eos = &nodes[ENCHANT_TRIE_EOS];
+	if (eos->value != ENCHANT_TRIE_NONE || eos->edges_size != 0 || eos->n_edges != 0)
+		return FALSE;
+
+	/* Each node is either unused, or reached from one edge at most */
+	enum { NODE_UNSEEN, NODE_FREE, NODE_REACHED };
+	guint8 *node_state = g_new0(guint8, header->n_nodes);
+	guint8 *edge_used = g_new0(guint8, MAX (header->n_edges, 1));
+	gboolean valid = FALSE;
+
+	guint32 node = header->free_nodes;
+	for (guint32 i = 0; node != ENCHANT_TRIE_NONE; i++, node = nodes[node].n_edges) {
+		if (i >= header->n_nodes || node == ENCHANT_TRIE_EOS || node >= header->n_nodes ||
+		    node_state[node] != NODE_UNSEEN)
+			goto done;
+		node_state[node] = NODE_FREE;
+	}
+
+	/* Unused blocks of edges are linked through their first edge */
+	for (int size_class = 0; size_class < ENCHANT_TRIE_EDGE_CLASSES; size_class++) {
+		guint32 size = 1u << size_class;
+		guint32 block = header->free_edges[size_class];
+		for (; block != ENCHANT_TRIE_NONE; block = edges[block].node) {
+			if (block >= header->n_edges || size > header->n_edges - block)
+				goto done;
+			for (guint32 e = block; e < block + size; e++)
+				if (edge_used[e]++)
+					goto done;
+		}
+	}
+
+	if (header->root != ENCHANT_TRIE_NONE) {
+		if (header->root == ENCHANT_TRIE_EOS || node_state[header->root] != NODE_UNSEEN)
+			goto done;
+		node_state[header->root] = NODE_REACHED;
+	}
+
+	for (node = 1; node < header->n_nodes; node++) {
+		const EnchantTrieNode *n = &nodes[node];
+		if (node_state[node] == NODE_FREE)
+			continue;
+		if (n->value != ENCHANT_TRIE_NONE && n->value >= header->n_strings)
+			goto done;
+		if (n->edges_size == 0) {
+			if (n->n_edges != 0)
+				goto done;
+			continue;
+		}
+
+		/* Blocks of edges have the sizes enchant_trie_edges_new gives */
+		if ((n->edges_size & (n->edges_size - 1)) != 0 || n->n_edges > n->edges_size ||
+		    n->edges >= header->n_edges || n->edges_size > header->n_edges - n->edges)
+			goto done;
+		for (guint32 e = n->edges; e < n->edges + n->edges_size; e++)
+			if (edge_used[e]++)
+				goto done;
+
+		for (guint32 e = n->edges; e < n->edges + n->n_edges; e++) {
+			guint32 sub = edges[e].node;
+			if (sub >= header->n_nodes || (edges[e].ch == 0) != (sub == ENCHANT_TRIE_EOS) ||
+			    (e > n->edges && edges[e - 1].ch >= edges[e].ch))
+				goto done;
+			if (sub == ENCHANT_TRIE_EOS)
+				continue;
+			if (node_state[sub] != NODE_UNSEEN)
+				goto done;
+			node_state[sub] = NODE_REACHED;
+		}
+	}
+
+	/* The strings are searched character by character */
+	for (const char *p = strings, *end = strings + header->n_strings; p < end; p += strlen(p) + 1)
+		if (!g_utf8_validate(p, -1, NULL))
+			goto done;
+
+	valid = TRUE;
+ done:
+	g_free(edge_used);
+	g_free(node_state);
+	return valid;
+}
+
+/* Returns: whether the originals listed in an index lie within it */
+static gboolean enchant_pwl_index_originals_are_valid(const EnchantPWLIndexHeader *header,
+						      const guint32 *originals,
+						      const char *originals_strings)
+{
+	for (guint32 i = 0; i < header->n_originals; i++) {
+		if (originals[i] >= header->originals_size)
+			return FALSE;
+		/* the normalized word must be followed by the original */
+		const char *normalized_word = originals_strings + originals[i];
+		if (originals[i] + strlen(normalized_word) + 1 >= header->originals_size)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* Borrow the trie from the index of the PWL file, if it is up to date.
+ * Returns: TRUE if the index was loaded */
+static gboolean enchant_pwl_load_index(EnchantPWL* pwl, const GStatBuf *stats)
+{
+	if (!pwl->compiled_index)
+		return FALSE;
+
+	char *index_filename = enchant_pwl_index_filename(pwl);
+	GMappedFile *index = g_mapped_file_new(index_filename, FALSE, NULL);
+	g_free(index_filename);
+	if (index == NULL)
+		return FALSE;
+
+	const char *contents = g_mapped_file_get_contents(index);
+	gsize length = g_mapped_file_get_length(index);
+	EnchantPWLIndexHeader header;
+	if (length < sizeof(header))
+		goto invalid;
+	memcpy(&header, contents, sizeof(header));
+
+	if (memcmp(header.magic, ENCHANT_PWL_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+	    header.byte_order != ENCHANT_PWL_INDEX_BYTE_ORDER ||
+	    header.version != ENCHANT_PWL_INDEX_VERSION ||
+	    header.source_mtime != (gint64)stats->st_mtime ||
+	    header.source_mtime_nsec != (gint64)get_stat_mtime_ns(stats) ||
+	    header.source_size != (guint64)stats->st_size ||
+	    header.source_ino != (guint64)stats->st_ino)
+		goto invalid;
+
+	/* The sizes come from the file, so are added up without overflowing */
+	if (header.n_strings > length || header.originals_size > length ||
+	    header.n_strings >= ENCHANT_TRIE_NONE || header.originals_size >= G_MAXUINT32)
+		goto invalid;
+	guint64 nodes_offset = sizeof(header);
+	guint64 edges_offset = nodes_offset + (guint64)header.n_nodes * sizeof(EnchantTrieNode);
+	guint64 originals_offset = edges_offset + (guint64)header.n_edges * sizeof(EnchantTrieEdge);
+	guint64 strings_offset = originals_offset + (guint64)header.n_originals * sizeof(guint32);
+	guint64 originals_strings_offset = strings_offset + header.n_strings;
+	if (header.n_nodes == 0 ||
+	    (header.root != ENCHANT_TRIE_NONE && header.root >= header.n_nodes) ||
+	    originals_strings_offset + header.originals_size != length ||
+	    (header.n_strings > 0 && contents[originals_strings_offset - 1] != '\0') ||
+	    (header.originals_size > 0 && contents[length - 1] != '\0') ||
+	    (header.n_originals > 0 && header.originals_size == 0))
+		goto invalid;
+
+	if (!enchant_pwl_index_trie_is_valid(&header,
+					     (const EnchantTrieNode *)(contents + nodes_offset),
+					     (const EnchantTrieEdge *)(contents + edges_offset),
+					     contents + strings_offset) ||
+	    !enchant_pwl_index_originals_are_valid(&header,
+						   (const guint32 *)(contents + originals_offset),
+						   contents + originals_strings_offset))
+		goto invalid;
+
+	EnchantTrie *trie = pwl->trie;
+	enchant_trie_free(trie);
+	trie = pwl->trie = g_new0(EnchantTrie, 1);
+	trie->read_only = TRUE;
+	trie->nodes = (EnchantTrieNode *)(contents + nodes_offset);
+	trie->n_nodes = trie->nodes_size = header.n_nodes;
+	trie->free_nodes = header.free_nodes;
+	trie->edges = (EnchantTrieEdge *)(contents + edges_offset);
+	trie->n_edges = trie->edges_size = header.n_edges;
+	memcpy(trie->free_edges, header.free_edges, sizeof(trie->free_edges));
+	trie->strings = (char *)(contents + strings_offset);
+	trie->n_strings = trie->strings_size = header.n_strings;
+	trie->root = header.root;
+
+	pwl->index = index;
+	pwl->n_index_words = header.n_words;
+	pwl->dead_lines = header.n_dead_lines;
+	pwl->originals = (const guint32 *)(contents + originals_offset);
+	pwl->n_originals = header.n_originals;
+	pwl->originals_strings = contents + originals_strings_offset;
+	return TRUE;
+
+ invalid:
+	g_mapped_file_unref(index);
+	return FALSE;
+}
+
+static gint enchant_pwl_compare_words(gconstpointer a, gconstpointer b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* Write the trie to the index of the PWL file, for the file as described
+ * by stats */
+static void enchant_pwl_save_index(EnchantPWL* pwl, const GStatBuf *stats)
+{
+	EnchantTrie *trie = pwl->trie;
+	if (!pwl->compiled_index || g_hash_table_size(pwl->words_in_trie) == 0)
+		return;
+
+	GPtrArray *originals = g_ptr_array_new();
+	gsize originals_size = 0;
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init(&iter, pwl->words_in_trie);
+	while (g_hash_table_iter_next(&iter, &key, &value))
+		if (strcmp(key, value) != 0) {
+			g_ptr_array_add(originals, key);
+			originals_size += strlen(key) + strlen(value) + 2;
+		}
+	g_ptr_array_sort(originals, enchant_pwl_compare_words);
+
+	EnchantPWLIndexHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, ENCHANT_PWL_INDEX_MAGIC, sizeof(header.magic));
+	header.version = ENCHANT_PWL_INDEX_VERSION;
+	header.byte_order = ENCHANT_PWL_INDEX_BYTE_ORDER;
+	header.root = trie->root;
+	header.source_mtime = stats->st_mtime;
+	header.source_mtime_nsec = get_stat_mtime_ns(stats);
+	header.source_size = stats->st_size;
+	header.source_ino = stats->st_ino;
+	header.n_nodes = trie->n_nodes;
+	header.free_nodes = trie->free_nodes;
+	header.n_edges = trie->n_edges;
+	memcpy(header.free_edges, trie->free_edges, sizeof(header.free_edges));
+	header.n_originals = originals->len;
+	header.n_words = g_hash_table_size(pwl->words_in_trie);
+	header.n_dead_lines = pwl->dead_lines;
+	header.n_strings = trie->n_strings;
+	header.originals_size = originals_size;
+
+	gsize length = sizeof(header) +
+		trie->n_nodes * sizeof(EnchantTrieNode) +
+		trie->n_edges * sizeof(EnchantTrieEdge) +
+		originals->len * sizeof(guint32) +
+		trie->n_strings + originals_size;
+	char *contents = g_new(char, length);
+	char *p = contents;
+	memcpy(p, &header, sizeof(header));
+	p += sizeof(header);
+	memcpy(p, trie->nodes, trie->n_nodes * sizeof(EnchantTrieNode));
+	p += trie->n_nodes * sizeof(EnchantTrieNode);
+	if (trie->n_edges > 0)
+		memcpy(p, trie->edges, trie->n_edges * sizeof(EnchantTrieEdge));
+	p += trie->n_edges * sizeof(EnchantTrieEdge);
+	guint32 *offsets = (guint32 *)p;
+	p += originals->len * sizeof(guint32);
+	memcpy(p, trie->strings, trie->n_strings);
+	p += trie->n_strings;
+
+	char *originals_strings = p;
+	for (guint i = 0; i < originals->len; i++) {
+		const char *normalized_word = g_ptr_array_index(originals, i);
+		const char *original = g_hash_table_lookup(pwl->words_in_trie, normalized_word);
+		offsets[i] = (guint32)(p - originals_strings);
+		p = g_stpcpy(p, normalized_word) + 1;
+		p = g_stpcpy(p, original) + 1;
+	}
+	g_ptr_array_free(originals, TRUE);
+
+	/* Failing to write the index only costs speed */
+	char *index_filename = enchant_pwl_index_filename(pwl);
+	g_file_set_contents(index_filename, contents, length, NULL);
+	g_free(index_filename);
+	g_free(contents);
+}
+
+static void enchant_pwl_collect_word(const char *word, gpointer data)
+{
+	EnchantPWL *pwl = data;
+	g_hash_table_insert(pwl->words_in_trie, g_strdup(word),
+			    g_strdup(enchant_pwl_lookup_original(pwl, word)));
+}
+
+/* Copy the trie out of the index, or expand the minimized trie, so that
+ * it can be modified */
+static void enchant_pwl_unshare_index(EnchantPWL* pwl)
+{
+	if (!pwl->trie->read_only)
+		return;
+
+	enchant_trie_foreach_word(pwl->trie, enchant_pwl_collect_word, pwl);
+	enchant_trie_unshare(pwl->trie);
+	enchant_pwl_drop_index(pwl);
+}
+
+/* Let go of the index, or of the originals of the minimized trie, once
+ * the trie no longer comes from them */
+static void enchant_pwl_drop_index(EnchantPWL* pwl)
+{
+	if (pwl->index) {
+		g_mapped_file_unref(pwl->index);
+		pwl->index = NULL;
+	}
+	g_free(pwl->originals_block);
+	pwl->originals_block = NULL;
+	pwl->n_index_words = 0;
+	pwl->originals = NULL;
+	pwl->n_originals = 0;
+	pwl->originals_strings = NULL;
+}
+
+static gint enchant_pwl_compare_entries(gconstpointer a, gconstpointer b)
+{
+	const EnchantPWLEntry *entry_a = a, *entry_b = b;
+	int cmp = strcmp(entry_a->word, entry_b->word);
+	if (cmp != 0)
+		return cmp;
+	return (entry_a->line > entry_b->line) - (entry_a->line < entry_b->line);
+}
+
+/* Make the trie a minimized trie of the words read from the file, and
+ * list the original spelling of those not read normalized */
+static void enchant_pwl_load_minimized(EnchantPWL* pwl, GArray *entries)
+{
+	g_array_sort(entries, enchant_pwl_compare_entries);
+
+	/* Of the lines of a word, the first since its last tombstone is
+	 * kept, as by enchant_pwl_add_to_trie, if there is one */
+	EnchantPWLEntry *e = (EnchantPWLEntry *)(void *)entries->data;
+	guint32 n_words = 0, n_originals = 0;
+	gsize originals_size = 0;
+	for (guint i = 0, next; i < entries->len; i = next) {
+		guint kept = G_MAXUINT;
+		for (next = i; next < entries->len && strcmp(e[next].word, e[i].word) == 0; next++)
+			if (e[next].removed)
+				kept = G_MAXUINT;
+			else if (kept == G_MAXUINT)
+				kept = next;
+		for (guint j = i; j < next; j++)
+			if (j != kept) {
+				g_free(e[j].word);
+				g_free(e[j].original);
+			}
+		if (kept == G_MAXUINT)
+			continue;
+
+		e[n_words++] = e[kept];
+		if (e[kept].original) {
+			n_originals++;
+			originals_size += strlen(e[kept].word) + strlen(e[kept].original) + 2;
+		}
+	}
+
+	char **words = g_new(char *, MAX (n_words, 1));
+	for (guint32 i = 0; i < n_words; i++)
+		words[i] = e[i].word;
+	enchant_trie_build_minimized(pwl->trie, words, n_words);
+	g_free(words);
+
+	guint32 *offsets = pwl->originals_block = g_malloc(n_originals * sizeof(guint32) + originals_size);
+	char *originals_strings = (char *)(offsets + n_originals);
+	char *p = originals_strings;
+	for (guint32 i = 0, j = 0; i < n_words; i++) {
+		if (e[i].original) {
+			offsets[j++] = (guint32)(p - originals_strings);
+			p = g_stpcpy(p, e[i].word) + 1;
+			p = g_stpcpy(p, e[i].original) + 1;
+		}
+		g_free(e[i].word);
+		g_free(e[i].original);
+	}
+	g_array_free(entries, TRUE);
+
+	pwl->n_index_words = n_words;
+	pwl->originals = offsets;
+	pwl->n_originals = n_originals;
+	pwl->originals_strings = originals_strings;
+}
+
+/* Returns: the word as it was added to the PWL, given its normalized form */
+static const char* enchant_pwl_lookup_original(EnchantPWL* pwl, const char *normalized_word)
+{
+	if (!pwl->trie->read_only)
+		return g_hash_table_lookup(pwl->words_in_trie, normalized_word);
+
+	guint32 lo = 0, hi = pwl->n_originals;
+	while (lo < hi) {
+		guint32 mid = lo + (hi - lo) / 2;
+		const char *entry = pwl->originals_strings + pwl->originals[mid];
+		int cmp = strcmp(entry, normalized_word);
+		if (cmp < 0)
+			lo = mid + 1;
+		else if (cmp > 0)
+			hi = mid;
+		else
+			return entry + strlen(entry) + 1;
+	}
+	return normalized_word;
+}
+
+#ifdef HAVE_SYS_INOTIFY_H
+/* All PWLs watched with inotify share one inotify instance, read by a
+ * thread which flags a PWL when its file changes.  Watches are set on
+ * the directory of the file, so that the file being replaced is seen. */
+G_LOCK_DEFINE_STATIC (watcher);
+static int watcher_fd = -1;
+static GSList *watched_pwls = NULL;
+
+static gpointer enchant_pwl_watcher_thread(gpointer data _GL_UNUSED_PARAMETER)
+{
+	char buffer[4096] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+	for (;;) {
+		ssize_t len = read(watcher_fd, buffer, sizeof(buffer));
+		if (len < 0 && errno == EINTR)
+			continue;
+
+		G_LOCK (watcher);
+		if (len <= 0) {
+			/* Can't watch any more, so fall back to throttling */
+			for (GSList *l = watched_pwls; l != NULL; l = l->next)
+				g_atomic_int_set(&((EnchantPWL *)l->data)->watch, -1);
+			close(watcher_fd);
+			watcher_fd = -1;
+			G_UNLOCK (watcher);
+			break;
+		}
+
+		for (char *p = buffer; p < buffer + len; ) {
+			const struct inotify_event *event = (const struct inotify_event *)p;
+			for (GSList *l = watched_pwls; l != NULL; l = l->next) {
+				EnchantPWL *pwl = l->data;
+				if (event->mask & IN_Q_OVERFLOW)
+					g_atomic_int_set(&pwl->file_touched, 1);
+				else if (event->wd == pwl->watch) {
+					if (event->mask & IN_IGNORED) {
+						/* the directory is gone */
+						g_atomic_int_set(&pwl->watch, -1);
+						g_atomic_int_set(&pwl->file_touched, 1);
+					} else if (event->len > 0 && strcmp(event->name, pwl->watch_name) == 0)
+						g_atomic_int_set(&pwl->file_touched, 1);
+				}
+			}
+			p += sizeof(struct inotify_event) + event->len;
+		}
+		G_UNLOCK (watcher);
+	}
+
+	return NULL;
+}
+
+static void enchant_pwl_watch(EnchantPWL *pwl)
+{
+	if (pwl->watch_name != NULL || pwl->filename == NULL)
+		return;
+
+	G_LOCK (watcher);
+	if (watcher_fd == -1) {
+		watcher_fd = inotify_init1(IN_CLOEXEC);
+		if (watcher_fd != -1)
+			g_thread_unref(g_thread_new("enchant-pwl-watcher", enchant_pwl_watcher_thread, NULL));
+	}
+
+	if (watcher_fd != -1) {
+		char *dirname = g_path_get_dirname(pwl->filename);
+		int watch = inotify_add_watch(watcher_fd, dirname,
+					      IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE |
+					      IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+		g_free(dirname);
+		if (watch != -1) {
+			pwl->watch = watch;
+			pwl->watch_name = g_path_get_basename(pwl->filename);
+			watched_pwls = g_slist_prepend(watched_pwls, pwl);
+		}
+	}
+	G_UNLOCK (watcher);
+}
+
+static void enchant_pwl_unwatch(EnchantPWL *pwl)
+{
+	if (pwl->watch_name == NULL)
+		return;
+
+	G_LOCK (watcher);
+	watched_pwls = g_slist_remove(watched_pwls, pwl);
+
+	gboolean shared = FALSE;
+	for (GSList *l = watched_pwls; l != NULL; l = l->next)
+		if (((EnchantPWL *)l->data)->watch == pwl->watch)
+			shared = TRUE;
+	if (!shared && pwl->watch != -1)
+		inotify_rm_watch(watcher_fd, pwl->watch);
+
+	pwl->watch = -1;
+	g_free(pwl->watch_name);
+	pwl->watch_name = NULL;
+	G_UNLOCK (watcher);
+}
+#else
+static void enchant_pwl_watch(EnchantPWL *pwl _GL_UNUSED_PARAMETER)
+{
+}
+
+static void enchant_pwl_unwatch(EnchantPWL *pwl _GL_UNUSED_PARAMETER)
+{
+}
+#endif
+
+void enchant_pwl_set_refresh_policy(EnchantPWL *pwl, EnchantPWLRefreshPolicy policy,
+				    unsigned int interval_ms)
+{
+	g_return_if_fail (pwl != NULL);
+
+	enchant_pwl_lock(pwl);
+	if (policy == ENCHANT_PWL_REFRESH_NOTIFY)
+		enchant_pwl_watch(pwl);
+	else
+		enchant_pwl_unwatch(pwl);
+
+	pwl->refresh_policy = policy;
+	pwl->refresh_interval = (gint64)interval_ms * 1000;
+
+	/* The file may have changed while it was not watched */
+	pwl->last_refresh = 0;
+	g_atomic_int_set(&pwl->file_touched, 1);
+	enchant_pwl_unlock(pwl);
+}
+
+/* Look for changes to the file, if the refresh policy says it is time to.
+ * Unless the file changed, this does not make any system call for the
+ * throttled or notified policies. */
+static void enchant_pwl_refresh_if_due(EnchantPWL* pwl)
+{
+	if (!pwl->loaded) {
+		/* the first read counts as the latest look for changes */
+		pwl->last_refresh = g_get_monotonic_time();
+		g_atomic_int_set(&pwl->file_touched, 0);
+		enchant_pwl_refresh_from_file(pwl);
+		return;
+	}
+
+	switch (pwl->refresh_policy) {
+	case ENCHANT_PWL_REFRESH_NOTIFY:
+		if (g_atomic_int_get(&pwl->watch) != -1) {
+			if (!g_atomic_int_compare_and_exchange(&pwl->file_touched, 1, 0))
+				return;
+			break;
+		}
+		/* fall through */
+	case ENCHANT_PWL_REFRESH_THROTTLED: {
+		gint64 now = g_get_monotonic_time();
+		if (now - pwl->last_refresh < pwl->refresh_interval)
+			return;
+		pwl->last_refresh = now;
+		break;
+	}
+	case ENCHANT_PWL_REFRESH_ALWAYS:
+	default:
+		break;
+	}
+
+	enchant_pwl_refresh_from_file(pwl);
+}
+
+void enchant_pwl_free(EnchantPWL *pwl)
+{
+	if (pwl->shared_path != NULL) {
+		G_LOCK (registry);
+		gboolean last = --pwl->ref_count == 0;
+		if (last) {
+			g_hash_table_remove (registry, pwl->shared_path);
+			if (g_hash_table_size (registry) == 0) {
+				g_hash_table_destroy (registry);
+				registry = NULL;
+			}
+		}
+		G_UNLOCK (registry);
+		if (!last)
+			return;
+
+		g_mutex_clear(&pwl->lock);
+		g_free(pwl->shared_path);
+	}
+
+	enchant_pwl_unwatch(pwl);
+	enchant_trie_free(pwl->trie);
+	enchant_pwl_free_folded(pwl);
+	enchant_pwl_filter_free(pwl);
+	enchant_pwl_deletions_free(pwl->deletions);
+	enchant_pwl_drop_index(pwl);
+	g_free(pwl->filename);
+	g_hash_table_destroy (pwl->words_in_trie);
+	g_free(pwl);
+}
+
+static char* enchant_utf8_fold(const char *word)
+{
+	GString *folded = g_string_sized_new(strlen(word));
+	for (const char *p = word; *p; p = g_utf8_next_char(p))
+		g_string_append_unichar(folded, enchant_unichar_fold(g_utf8_get_char(p)));
+	return g_string_free(folded, FALSE);
+}
+
+static void enchant_pwl_add_folded(const char *normalized_word, gpointer data)
+{
+	EnchantPWL *pwl = data;
+	enchant_trie_unshare(pwl->folded_trie);
+
+	char *folded_word = enchant_utf8_fold(normalized_word);
+	GSList *words = g_hash_table_lookup(pwl->folded_words, folded_word);
+	if (words == NULL) {
+		if (enchant_trie_contains(pwl->folded_trie, folded_word))
+			words = g_slist_prepend(NULL, g_strdup(folded_word));
+		else {
+			enchant_trie_insert(pwl->folded_trie, folded_word);
+			if (strcmp(folded_word, normalized_word) == 0) {
+				g_free(folded_word);
+				return;
+			}
+		}
+	}
+	g_hash_table_insert(pwl->folded_words, folded_word,
+			    g_slist_prepend(words, g_strdup(normalized_word)));
+}
+
+static void enchant_pwl_remove_folded(EnchantPWL *pwl, const char *normalized_word)
+{
+	enchant_trie_unshare(pwl->folded_trie);
+
+	char *folded_word = enchant_utf8_fold(normalized_word);
+	GSList *words = g_hash_table_lookup(pwl->folded_words, folded_word);
+	if (words == NULL) {
+		enchant_trie_remove(pwl->folded_trie, folded_word);
+		g_free(folded_word);
+		return;
+	}
+
+	for (GSList *l = words; l != NULL; l = l->next)
+		if (strcmp(l->data, normalized_word) == 0) {
+			g_free(l->data);
+			words = g_slist_delete_link(words, l);
+			break;
+		}
+
+	if (words == NULL) {
+		g_hash_table_remove(pwl->folded_words, folded_word);
+		enchant_trie_remove(pwl->folded_trie, folded_word);
+		g_free(folded_word);
+	} else
+		g_hash_table_insert(pwl->folded_words, folded_word, words);
+}
+
+typedef struct {
+	EnchantPWL *pwl;
+	GPtrArray *folded_words;
+} EnchantPWLFolder;
+
+static void enchant_pwl_collect_folded(const char *normalized_word, gpointer data)
+{
+	EnchantPWLFolder *folder = data;
+	GHashTable *folded_words = folder->pwl->folded_words;
+	char *folded_word = enchant_utf8_fold(normalized_word);
+	g_ptr_array_add(folder->folded_words, folded_word);
+	if (strcmp(folded_word, normalized_word) == 0)
+		return;
+
+	GSList *words = g_hash_table_lookup(folded_words, folded_word);
+	if (words == NULL && enchant_trie_contains(folder->pwl->trie, folded_word))
+		words = g_slist_prepend(NULL, g_strdup(folded_word));
+	g_hash_table_insert(folded_words, g_strdup(folded_word),
+			    g_slist_prepend(words, g_strdup(normalized_word)));
+}
+
+/* Fold a minimized trie into a minimized trie */
+static void enchant_pwl_fold_minimized(EnchantPWL *pwl)
+{
+	EnchantPWLFolder folder;
+	folder.pwl = pwl;
+	folder.folded_words = g_ptr_array_new();
+	enchant_trie_foreach_word(pwl->trie, enchant_pwl_collect_folded, &folder);
+
+	GPtrArray *folded_words = folder.folded_words;
+	g_ptr_array_sort(folded_words, enchant_pwl_compare_words);
+	guint n_words = 0;
+	for (guint i = 0; i < folded_words->len; i++) {
+		char *folded_word = g_ptr_array_index(folded_words, i);
+		if (n_words > 0 && strcmp(folded_word, g_ptr_array_index(folded_words, n_words - 1)) == 0)
+			g_free(folded_word);
+		else
+			g_ptr_array_index(folded_words, n_words++) = folded_word;
+	}
+	enchant_trie_build_minimized(pwl->folded_trie, (char **)folded_words->pdata, n_words);
+
+	for (guint i = 0; i < n_words; i++)
+		g_free(g_ptr_array_index(folded_words, i));
+	g_ptr_array_free(folded_words, TRUE);
+}
+
+/* Returns: the trie of case folded words, made from the trie if need be */
+static EnchantTrie* enchant_pwl_get_folded_trie(EnchantPWL *pwl)
+{
+	if (pwl->folded_trie == NULL) {
+		pwl->folded_trie = enchant_trie_new();
+		pwl->folded_words = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+		if (pwl->trie->minimized)
+			enchant_pwl_fold_minimized(pwl);
+		else
+			enchant_trie_foreach_word(pwl->trie, enchant_pwl_add_folded, pwl);
+	}
+	return pwl->folded_trie;
+}
+
+static void enchant_pwl_free_folded(EnchantPWL *pwl)
+{
+	if (pwl->folded_trie == NULL)
+		return;
+
+	GHashTableIter iter;
+	gpointer value;
+	g_hash_table_iter_init(&iter, pwl->folded_words);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		g_slist_free_full(value, g_free);
+	g_hash_table_destroy(pwl->folded_words);
+	enchant_trie_free(pwl->folded_trie);
+	pwl->folded_words = NULL;
+	pwl->folded_trie = NULL;
+}
+
+static inline guint64 enchant_hash_mix(guint64 h)
+{
+	h ^= h >> 33;
+	h *= G_GUINT64_CONSTANT(0xff51afd7ed558ccd);
+	h ^= h >> 33;
+	h *= G_GUINT64_CONSTANT(0xc4ceb9fe1a85ec53);
+	h ^= h >> 33;
+	return h;
+}
+
+static inline guint64 enchant_hash_unichar(guint64 h, gunichar ch)
+{
+	return (h ^ enchant_unichar_fold(ch)) * G_GUINT64_CONSTANT(0x100000001b3);
+}
+
+/* Returns: the hash of the case folded form of the n characters in chars */
+static guint64 enchant_pwl_filter_hash_chars(const gunichar *chars, glong n)
+{
+	guint64 h = G_GUINT64_CONSTANT(0xcbf29ce484222325);
+	for (glong i = 0; i < n; i++)
+		h = enchant_hash_unichar(h, chars[i]);
+	return enchant_hash_mix(h);
+}
+
+/* Returns: the hash of the case folded form of a word */
+static guint64 enchant_pwl_filter_hash(const char *word)
+{
+	guint64 h = G_GUINT64_CONSTANT(0xcbf29ce484222325);
+	for (const char *p = word; *p; p = g_utf8_next_char(p))
+		h = enchant_hash_unichar(h, g_utf8_get_char(p));
+	return enchant_hash_mix(h);
+}
+
+static void enchant_pwl_filter_set(EnchantPWLFilter *filter, guint64 hash)
+{
+	guint64 *block = filter->blocks + 8 * (hash & (filter->n_blocks - 1));
+	guint64 bits = enchant_hash_mix(hash ^ G_GUINT64_CONSTANT(0x9e3779b97f4a7c15));
+	for (int i = 0; i < ENCHANT_PWL_FILTER_PROBES; i++, bits >>= 9)
+		block[(bits >> 6) & 7] |= G_GUINT64_CONSTANT(1) << (bits & 63);
+	filter->n_changes++;
+}
+
+static gboolean enchant_pwl_filter_test(const EnchantPWLFilter *filter, guint64 hash)
+{
+	const guint64 *block = filter->blocks + 8 * (hash & (filter->n_blocks - 1));
+	guint64 bits = enchant_hash_mix(hash ^ G_GUINT64_CONSTANT(0x9e3779b97f4a7c15));
+	for (int i = 0; i < ENCHANT_PWL_FILTER_PROBES; i++, bits >>= 9)
+		if (!(block[(bits >> 6) & 7] & (G_GUINT64_CONSTANT(1) << (bits & 63))))
+			return FALSE;
+	return TRUE;
+}
+
+static void enchant_pwl_filter_add_word(const char *normalized_word, gpointer data)
+{
+	enchant_pwl_filter_set(data, enchant_pwl_filter_hash(normalized_word));
+}
+
+/* Returns: the membership filter of the words, made from the trie if need be */
+static EnchantPWLFilter* enchant_pwl_get_filter(EnchantPWL *pwl)
+{
+	if (pwl->filter == NULL) {
+		guint32 n_words = pwl->trie->read_only ? pwl->n_index_words : g_hash_table_size(pwl->words_in_trie);
+
+		/* leave room for as many words again to be added */
+		EnchantPWLFilter *filter = g_new0(EnchantPWLFilter, 1);
+		filter->capacity = 2 * n_words + 64;
+		filter->n_blocks = 1;
+		while ((guint64)filter->n_blocks * 512 < (guint64)filter->capacity * ENCHANT_PWL_FILTER_BITS_PER_WORD)
+			filter->n_blocks *= 2;
+		filter->blocks = g_new0(guint64, 8 * (gsize)filter->n_blocks);
+		enchant_trie_foreach_word(pwl->trie, enchant_pwl_filter_add_word, filter);
+		pwl->filter = filter;
+	}
+	return pwl->filter;
+}
+
+/* Note that a word was added to or removed from the trie */
+static void enchant_pwl_filter_update(EnchantPWL *pwl, const char *normalized_word, gboolean added)
+{
+	if (pwl->filter == NULL)
+		return;
+
+	if (pwl->filter->n_changes >= pwl->filter->capacity) {
+		/* Build afresh when next needed */
+		enchant_pwl_filter_free(pwl);
+		return;
+	}
+
+	if (added)
+		enchant_pwl_filter_set(pwl->filter, enchant_pwl_filter_hash(normalized_word));
+	else
+		pwl->filter->n_changes++;
+}
+
+static void enchant_pwl_filter_free(EnchantPWL *pwl)
+{
+	if (pwl->filter == NULL)
+		return;
 
-struct str_enchant_pwl
+	g_free(pwl->filter->blocks);
+	g_free(pwl->filter);
+	pwl->filter = NULL;
+}
+
+/* Returns: whether a normalized word, whose filter hash is given, is in
+ * the trie, looking it up only if the filter does not rule it out */
+static int enchant_pwl_contains_normalized(EnchantPWL *pwl, const char *normalized_word, guint64 hash)
 {
-	EnchantTrie* trie;
-	char * filename;
-	time_t file_changed;
-	GHashTable *words_in_trie;
-};
+	pwl->filter_lookups++;
+	if (!enchant_pwl_filter_test(enchant_pwl_get_filter(pwl), hash)) {
+		pwl->filter_rejected++;
+		return 0;
+	}
 
-/* Special Trie node indicating the end of a string */
-static EnchantTrie n_EOSTrie;
-static EnchantTrie* EOSTrie = &n_EOSTrie;
+	if (enchant_trie_contains(pwl->trie, normalized_word))
+		return 1;
+	pwl->filter_false_positives++;
+	return 0;
+}
 
-/* mode for searching trie */
-typedef enum enum_matcher_mode EnchantTrieMatcherMode;
-enum enum_matcher_mode
+void enchant_pwl_get_filter_stats(EnchantPWL *pwl, size_t *n_lookups, size_t *n_rejected,
+				  size_t *n_false_positives)
 {
-	case_sensitive,
-	case_insensitive
-};
+	g_return_if_fail (pwl != NULL);
+
+	enchant_pwl_lock(pwl);
+	if (n_lookups)
+		*n_lookups = pwl->filter_lookups;
+	if (n_rejected)
+		*n_rejected = pwl->filter_rejected;
+	if (n_false_positives)
+		*n_false_positives = pwl->filter_false_positives;
+	enchant_pwl_unlock(pwl);
+}
 
-/*  The EnchantTrieMatcher structure maintains the state necessary to
- *  search for matching strings within an EnchantTrie.  It includes a
- *  callback function which will be called with each matching string
- *  as it is found.  The arguments to this function are:
- *
- *      - a freshly-allocated copy of the matching string, which must
- *        be freed by external code
- *      - the EnchantTrieMatcher object, giving the context of the match
- *        (e.g. number of errors)
- */
-typedef struct str_enchant_trie_matcher EnchantTrieMatcher;
-struct str_enchant_trie_matcher
+void enchant_pwl_set_compiled_index(EnchantPWL *pwl, int enabled)
 {
-	int num_errors;		/* Num errors encountered so far. */
-	int max_errors;		/* Max errors before search should terminate */
+	g_return_if_fail (pwl != NULL);
 
-	char* word;	/* Word being searched for */
-	ssize_t word_pos;	/* Current position in the word */
+	enchant_pwl_lock(pwl);
+	pwl->compiled_index = enabled != 0;
+	enchant_pwl_unlock(pwl);
+}
 
-	char* path;		    /* Path taken through the trie so far */
-	ssize_t path_len;	/* Length of allocated path string */
-	ssize_t path_pos;	/* Current end pos of path string */
+void enchant_pwl_set_suggest_index(EnchantPWL *pwl, EnchantPWLSuggestIndex mode)
+{
+	g_return_if_fail (pwl != NULL);
 
-	EnchantTrieMatcherMode mode;
+	enchant_pwl_lock(pwl);
+	pwl->suggest_index = mode;
 
-	void (*cbfunc)(char*,EnchantTrieMatcher*); /* callback func */
-	void* cbdata;		/* Private data for use by callback func */
-};
+	/* Build afresh when next needed */
+	enchant_pwl_deletions_free(pwl->deletions);
+	pwl->deletions = NULL;
+	enchant_pwl_unlock(pwl);
+}
 
-/*  To allow the list of suggestions to be built up an item at a time,
- *  its state is maintained in an EnchantSuggList object.
- */
-typedef struct str_enchant_sugg_list
+/* Note that the words changed since the deletion index was built */
+static void enchant_pwl_deletions_invalidate(EnchantPWL *pwl)
 {
-	char** suggs;
-	int* sugg_errs;
-	size_t n_suggs;
-} EnchantSuggList;
+	if (pwl->deletions != NULL && !pwl->deletions_stale) {
+		pwl->deletions_stale = TRUE;
+		pwl->stale_visited_nodes = pwl->visited_nodes;
+	}
+}
 
-/*
- *   Function Prototypes
- */
+/* Returns: the deletion index to search for suggestions, built if it is
+ * due, or NULL if the trie is to be searched */
+static EnchantPWLDeletions* enchant_pwl_get_deletions(EnchantPWL *pwl)
+{
+	if (pwl->suggest_index == ENCHANT_PWL_SUGGEST_INDEX_NEVER)
+		return NULL;
 
-static void enchant_pwl_add_to_trie(EnchantPWL *pwl,
-					const char *const word, size_t len);
-static void enchant_pwl_refresh_from_file(EnchantPWL* pwl);
-static void enchant_pwl_check_cb(char* match,EnchantTrieMatcher* matcher);
-static void enchant_pwl_suggest_cb(char* match,EnchantTrieMatcher* matcher);
-static void enchant_trie_free(EnchantTrie* trie);
-static void enchant_trie_free_cb(void*,void*,void*);
-static EnchantTrie* enchant_trie_insert(EnchantTrie* trie,const char *const word);
-static void enchant_trie_remove(EnchantTrie* trie,const char *const word);
-static void enchant_trie_find_matches(EnchantTrie* trie,EnchantTrieMatcher *matcher);
-static void enchant_trie_find_matches_cb(void* keyV,void* subtrieV,void* matcherV);
-static EnchantTrieMatcher* enchant_trie_matcher_init(const char* const word, size_t len,
-				int maxerrs,
-				EnchantTrieMatcherMode mode,
-				void(*cbfunc)(char*,EnchantTrieMatcher*),
-				void* cbdata);
-static void enchant_trie_matcher_free(EnchantTrieMatcher* matcher);
-static void enchant_trie_matcher_pushpath(EnchantTrieMatcher* matcher,char* newchars);
-static void enchant_trie_matcher_poppath(EnchantTrieMatcher* matcher,int num);
+	guint n_words = pwl->trie->read_only ? pwl->n_index_words : g_hash_table_size(pwl->words_in_trie);
+	if (pwl->suggest_index == ENCHANT_PWL_SUGGEST_INDEX_AUTO &&
+	    n_words < ENCHANT_PWL_DELETIONS_THRESHOLD) {
+		enchant_pwl_deletions_free(pwl->deletions);
+		pwl->deletions = NULL;
+		return NULL;
+	}
 
-static int edit_dist(const char* word1, const char* word2);
+	/* Rebuilding on every change would make adding words to a large list
+	 * slow, so while the index is out of date the trie is searched, until
+	 * that has cost about as much as rebuilding */
+	if (pwl->deletions != NULL && pwl->deletions_stale) {
+		if (pwl->visited_nodes - pwl->stale_visited_nodes < pwl->deletions->n_entries)
+			return NULL;
+		enchant_pwl_deletions_free(pwl->deletions);
+		pwl->deletions = NULL;
+	}
 
-#define enchant_lock_file(f) flock (fileno (f), LOCK_EX)
-#define enchant_unlock_file(f) flock (fileno (f), LOCK_UN)
+	if (pwl->deletions == NULL) {
+		pwl->deletions = enchant_pwl_deletions_new(pwl->trie);
+		pwl->deletions_stale = FALSE;
+	}
+	return pwl->deletions;
+}
 
-/**
- * enchant_pwl_init
- *
- * Returns: a new PWL object used to store/check/suggest words.
- */
-EnchantPWL* enchant_pwl_init(void)
+/* Returns: FALSE if the word was already in the PWL */
+static gboolean enchant_pwl_add_to_trie(EnchantPWL *pwl,
+					const char *const word, size_t len)
 {
-	EnchantPWL *pwl = g_new0(EnchantPWL, 1);
-	pwl->words_in_trie = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
-
-	return pwl;
+	char * normalized_word = g_utf8_normalize (word, len, G_NORMALIZE_NFD);
+	return enchant_pwl_add_normalized(pwl, normalized_word, g_strndup(word,len));
 }
 
-/**
- * enchant_pwl_init_with_file
- *
- * Returns: a new PWL object used to store/check/suggest words
- * or NULL if the file cannot be opened or created
- */ 
-EnchantPWL* enchant_pwl_init_with_file(const char * file)
+/* Add a word given its normalized form, both of which the PWL takes.
+ * Returns: FALSE if the word was already in the PWL */
+static gboolean enchant_pwl_add_normalized(EnchantPWL *pwl, char *normalized_word, char *word)
 {
-	g_return_val_if_fail (file != NULL, NULL);
+	enchant_pwl_unshare_index(pwl);
 
-	FILE* fd = g_fopen(file, "a+");
-	if(fd == NULL)
-		return NULL;
-	fclose(fd);
-	EnchantPWL *pwl = enchant_pwl_init();
-	pwl->filename = g_strdup(file);
-	pwl->file_changed = 0;
+	if(NULL != g_hash_table_lookup (pwl->words_in_trie, normalized_word)) {
+		g_free (normalized_word);
+		g_free (word);
+		return FALSE;
+	}
+	
+	g_hash_table_insert (pwl->words_in_trie, normalized_word, word);
+	pwl->generation++;
+
+	enchant_trie_insert(pwl->trie, normalized_word);
+	enchant_pwl_filter_update(pwl, normalized_word, TRUE);
+	if (pwl->folded_trie != NULL)
+		enchant_pwl_add_folded(normalized_word, pwl);
+	enchant_pwl_deletions_invalidate(pwl);
+	return TRUE;
+}
 
-	enchant_pwl_refresh_from_file(pwl);
-	return pwl;
+/* Returns: TRUE if the word was in the PWL */
+static gboolean enchant_pwl_remove_from_trie(EnchantPWL *pwl,
+					const char *const word, size_t len)
+{
+	char * normalized_word = g_utf8_normalize (word, len, G_NORMALIZE_NFD);
+	gboolean removed = enchant_pwl_remove_normalized(pwl, normalized_word);
+	g_free(normalized_word);
+	return removed;
 }
 
-static void enchant_pwl_refresh_from_file(EnchantPWL* pwl)
+/* Returns: TRUE if the word was in the PWL */
+static gboolean enchant_pwl_remove_normalized(EnchantPWL *pwl, const char *normalized_word)
 {
-	GStatBuf stats;
-	if(!pwl->filename ||
-	   g_stat(pwl->filename, &stats) != 0 || /* presumably I won't be able to open the file either */
-	   pwl->file_changed == stats.st_mtime) /* nothing changed since last read */
-		return;
+	enchant_pwl_unshare_index(pwl);
+
+	if (!g_hash_table_remove (pwl->words_in_trie, normalized_word))
+		return FALSE;
+	pwl->generation++;
+
+	enchant_trie_remove(pwl->trie, normalized_word);
+	enchant_pwl_filter_update(pwl, normalized_word, FALSE);
+	if (pwl->folded_trie != NULL)
+		enchant_pwl_remove_folded(pwl, normalized_word);
+	enchant_pwl_deletions_invalidate(pwl);
+	return TRUE;
+}
 
-	enchant_trie_free(pwl->trie);
-	pwl->trie = NULL;
-	g_hash_table_destroy (pwl->words_in_trie);
-	pwl->words_in_trie = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+/* Open the file to write to it, locked, opening it again if it was
+ * replaced by compaction while waiting for the lock.
+ * Returns: the file, or NULL */
+static FILE* enchant_pwl_open_locked(EnchantPWL *pwl)
+{
+	for (;;) {
+		FILE *f = g_fopen(pwl->filename, "a+");
+		if (f == NULL)
+			return NULL;
 
-	FILE *f = g_fopen(pwl->filename, "r");
-	if (!f) 
-		return;
+		enchant_lock_file (f);
+		GStatBuf locked, current;
+		if (fstat(fileno(f), &locked) != 0 || g_stat(pwl->filename, &current) != 0 ||
+		    (locked.st_ino == current.st_ino && locked.st_dev == current.st_dev))
+			return f;
 
-	pwl->file_changed = stats.st_mtime;
+		enchant_unlock_file (f);
+		fclose (f);
+	}
+}
 
-	enchant_lock_file (f);
-	
-	char buffer[BUFSIZ + 1];
-	size_t line_number = 1;
-	for (; NULL != (fgets (buffer, sizeof (buffer), f)); ++line_number)
-		{
-			char *line = buffer;
-			if(line_number == 1 && BOM == g_utf8_get_char(line))
-				line = g_utf8_next_char(line);
+/* Append lines, each ending with a newline, to the file at once.
+ * Returns: TRUE if the file was read up to the lines, and so still is */
+static gboolean enchant_pwl_append_lines(EnchantPWL *pwl, const char *lines, size_t len)
+{
+	FILE *f = enchant_pwl_open_locked(pwl);
+	if (f == NULL)
+		return FALSE;
 
-			if(line[strlen(line)-1] != '\n' && !feof(f)) /* ignore lines longer than BUFSIZ. */ 
-				{
-					g_warning ("Line too long (ignored) in %s at line:%zu\n", pwl->filename, line_number);
-					while (NULL != (fgets (buffer, sizeof (buffer), f)))
-						{
-							if (line[strlen(buffer)-1]=='\n') 
-								break;
-						}
-					continue;
-				}
+	/* Since this function does not signal I/O
+	   errors, only use return values to avoid
+	   doing things that seem futile. */
 
-			g_strchomp(line);
-			if( line[0] && line[0] != '#')
-				{
-					if(g_utf8_validate(line, -1, NULL))
-						enchant_pwl_add_to_trie(pwl, line, strlen(line));
-					else
-						g_warning ("Bad UTF-8 sequence in %s at line:%zu\n", pwl->filename, line_number);
-				}
+	/* Unless another process wrote to the file since it
+	   was read, the file will be read up to these lines. */
+	GStatBuf stats;
+	gboolean up_to_date = fstat (fileno (f), &stats) == 0 &&
+		stats.st_ino == pwl->file_ino && stats.st_dev == pwl->file_dev &&
+		fseek (f, 0L, SEEK_END) == 0 && ftell (f) == pwl->file_size;
+
+	/* Add a newline if the file doesn't end with one. */
+	if (fseek (f, -1, SEEK_END) == 0)
+		{
+			int c = getc (f);
+			fseek (f, 0L, SEEK_CUR); /* ISO C requires positioning between read and write. */
+			if (c != '\n')
+				putc ('\n', f);
 		}
-	
+	fwrite (lines, sizeof(char), len, f);
+	fflush (f);
+
+	if (up_to_date && fstat (fileno (f), &stats) == 0)
+		{
+			pwl->file_changed = stats.st_mtime;
+			pwl->file_size = ftell (f);
+		}
+	else
+		up_to_date = FALSE;
 	enchant_unlock_file (f);
 	fclose (f);
+	return up_to_date;
 }
 
-void enchant_pwl_free(EnchantPWL *pwl)
-{
-	enchant_trie_free(pwl->trie);
-	g_free(pwl->filename);
-	g_hash_table_destroy (pwl->words_in_trie);
-	g_free(pwl);
-}
+typedef struct {
+	const char *start;             /* NULL if the line is dropped */
+	gsize len;                     /* with the newline */
+} EnchantPWLLine;
 
-static void enchant_pwl_add_to_trie(EnchantPWL *pwl,
-					const char *const word, size_t len)
+/* Returns: the lines of contents, but for those which no longer add a word */
+static GString* enchant_pwl_compacted_lines(const char *contents, gsize length)
 {
-	char * normalized_word = g_utf8_normalize (word, len, G_NORMALIZE_NFD);
-	if(NULL != g_hash_table_lookup (pwl->words_in_trie, normalized_word)) {
-		g_free (normalized_word);
-		return;
+	GString *compacted = g_string_sized_new(length);
+	const char *start = contents, *end = contents + length;
+	if (length >= 3 && memcmp(start, "\xef\xbb\xbf", 3) == 0) { /* BOM */
+		g_string_append_len(compacted, start, 3);
+		start += 3;
 	}
-	
-	g_hash_table_insert (pwl->words_in_trie, normalized_word, g_strndup(word,len));
 
-	pwl->trie = enchant_trie_insert(pwl->trie, normalized_word);
+	/* The lines read so far, and for each word the one adding it, plus one */
+	GArray *lines = g_array_new(FALSE, FALSE, sizeof(EnchantPWLLine));
+	GHashTable *words = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	for (const char *line = start; line < end; ) {
+		const char *eol = memchr(line, '\n', end - line);
+		const char *next_line = eol ? eol + 1 : end;
+		if (eol == NULL)
+			eol = end;
+		while (eol > line && g_ascii_isspace(eol[-1]))
+			eol--;
+
+		/* As read by enchant_pwl_parse_chunk */
+		EnchantPWLLine entry = { line, next_line - line };
+		gsize len = eol - line;
+		gboolean removed = len > ENCHANT_PWL_TOMBSTONE_LEN &&
+			memcmp(line, ENCHANT_PWL_TOMBSTONE, ENCHANT_PWL_TOMBSTONE_LEN) == 0;
+		const char *word = removed ? line + ENCHANT_PWL_TOMBSTONE_LEN : line;
+		if ((removed || (len > 0 && line[0] != '#')) && g_utf8_validate(word, eol - word, NULL)) {
+			char *normalized_word = g_utf8_normalize(word, eol - word, G_NORMALIZE_NFD);
+			guint added = GPOINTER_TO_UINT(g_hash_table_lookup(words, normalized_word));
+			/* a tombstone which removed nothing is kept, as it may be a
+			 * comment of someone else's */
+			if (added)
+				entry.start = NULL;
+			if (removed && added) {
+				g_array_index(lines, EnchantPWLLine, added - 1).start = NULL;
+				g_hash_table_remove(words, normalized_word);
+			}
+			if (removed || added)
+				g_free(normalized_word);
+			else
+				g_hash_table_insert(words, normalized_word, GUINT_TO_POINTER(lines->len + 1));
+		}
+		g_array_append_val(lines, entry);
+		line = next_line;
+	}
+	g_hash_table_destroy(words);
+
+	for (guint i = 0; i < lines->len; i++) {
+		const EnchantPWLLine *line = &g_array_index(lines, EnchantPWLLine, i);
+		if (line->start == NULL)
+			continue;
+		g_string_append_len(compacted, line->start, line->len);
+		if (line->start[line->len - 1] != '\n')
+			g_string_append_c(compacted, '\n');
+	}
+	g_array_free(lines, TRUE);
+	return compacted;
 }
 
-static void enchant_pwl_remove_from_trie(EnchantPWL *pwl,
-					const char *const word, size_t len)
+/* Rewrite the file without the lines which no longer add a word, into a
+ * temporary file which is then renamed over it, so that readers see all
+ * of either the old file or the new one */
+static void enchant_pwl_compact(EnchantPWL *pwl)
 {
-	char * normalized_word = g_utf8_normalize (word, len, G_NORMALIZE_NFD);
+	/* If the file cannot be replaced, wait for as many lines again */
+	pwl->dead_lines = 0;
 
-	if( g_hash_table_remove (pwl->words_in_trie, normalized_word) )
-		{
-			enchant_trie_remove(pwl->trie, normalized_word);
-			if(pwl->trie && pwl->trie->subtries == NULL && pwl->trie->value == NULL) {
-				enchant_trie_free (pwl->trie);
-				pwl->trie = NULL; /* make trie empty if has no content */
+	/* renaming would replace the link rather than the file */
+	if (g_file_test(pwl->filename, G_FILE_TEST_IS_SYMLINK))
+		return;
+
+	FILE *f = enchant_pwl_open_locked(pwl);
+	if (f == NULL)
+		return;
+
+	/* Only lines read can be known to be dead */
+	GStatBuf stats;
+	GMappedFile *mapped = NULL;
+	if (fstat(fileno(f), &stats) == 0 &&
+	    stats.st_ino == pwl->file_ino && stats.st_dev == pwl->file_dev &&
+	    stats.st_size == pwl->file_size &&
+	    (mapped = g_mapped_file_new_from_fd(fileno(f), FALSE, NULL)) != NULL) {
+		GString *compacted = enchant_pwl_compacted_lines(g_mapped_file_get_contents(mapped),
+								 g_mapped_file_get_length(mapped));
+		g_mapped_file_unref(mapped);
+
+		char *tmp_filename = g_strconcat(pwl->filename, ".XXXXXX", NULL);
+		int fd = g_mkstemp_full(tmp_filename, O_WRONLY, stats.st_mode & 0777);
+		FILE *out = fd != -1 ? fdopen(fd, "wb") : NULL;
+		if (out != NULL) {
+			/* The stats of the new file are taken before it replaces the
+			 * old one, when other processes may start writing to it */
+			gboolean written =
+				fwrite(compacted->str, sizeof(char), compacted->len, out) == compacted->len &&
+				fflush(out) == 0 && fsync(fileno(out)) == 0 &&
+				fstat(fileno(out), &stats) == 0;
+			if (fclose(out) != 0)
+				written = FALSE;
+
+			if (written && g_rename(tmp_filename, pwl->filename) == 0) {
+				pwl->file_changed = stats.st_mtime;
+				pwl->file_size = stats.st_size;
+				pwl->file_ino = stats.st_ino;
+				pwl->file_dev = stats.st_dev;
+				enchant_pwl_save_index(pwl, &stats);
 			}
+			else
+				g_unlink(tmp_filename);
 		}
-	
-	g_free(normalized_word);
+		else if (fd != -1) {
+			close(fd);
+			g_unlink(tmp_filename);
+		}
+		g_free(tmp_filename);
+		g_string_free(compacted, TRUE);
+	}
+
+	enchant_unlock_file (f);
+	fclose (f);
+}
+
+/* Compact the file once most of its lines are dead, or none is left
+ * alive, which leaves little to rewrite, or at once if it is small */
+static void enchant_pwl_compact_if_due(EnchantPWL *pwl)
+{
+	guint n_words = g_hash_table_size(pwl->words_in_trie);
+	if (pwl->dead_lines > 0 && pwl->file_size <= ENCHANT_PWL_COMPACT_SMALL_SIZE)
+		enchant_pwl_compact(pwl);
+	else if (pwl->dead_lines > n_words &&
+		 (pwl->dead_lines >= ENCHANT_PWL_COMPACT_MIN_LINES || n_words == 0))
+		enchant_pwl_compact(pwl);
 }
 
 void enchant_pwl_add(EnchantPWL *pwl,
 			 const char *const word, size_t len)
 {
+	enchant_pwl_add_many(pwl, &word, &len, 1, NULL);
+}
+
+void enchant_pwl_add_many(EnchantPWL *pwl, const char *const *words,
+			  const size_t *lens, size_t n_words, uint64_t *generation)
+{
+	enchant_pwl_lock(pwl);
 	enchant_pwl_refresh_from_file(pwl);
+	gboolean followed = generation != NULL && *generation == pwl->generation;
+
+	/* The file already has a line adding the words in the trie */
+	GString *lines = g_string_new(NULL);
+	for (size_t i = 0; i < n_words; i++)
+		if (enchant_pwl_add_to_trie(pwl, words[i], lens[i])) {
+			g_string_append_len(lines, words[i], lens[i]);
+			g_string_append_c(lines, '\n');
+		}
 
-	enchant_pwl_add_to_trie(pwl, word, len);
+	if (lines->len > 0 && pwl->filename != NULL && !pwl->read_only)
+		enchant_pwl_append_lines(pwl, lines->str, lines->len);
+	g_string_free(lines, TRUE);
 
-	if (pwl->filename != NULL)
-	{
-		FILE *f = g_fopen(pwl->filename, "a+");
-		if (f)
-			{
-				/* Since this function does not signal I/O
-				   errors, only use return values to avoid
-				   doing things that seem futile. */
-
-				enchant_lock_file (f);
-				GStatBuf stats;
-				if(g_stat(pwl->filename, &stats)==0)
-					pwl->file_changed = stats.st_mtime;
-
-				/* Add a newline if the file doesn't end with one. */
-				if (fseek (f, -1, SEEK_END) == 0)
-					{
-						int c = getc (f);
-						fseek (f, 0L, SEEK_CUR); /* ISO C requires positioning between read and write. */
-						if (c != '\n')
-							putc ('\n', f);
-					}
-
-				if (fwrite (word, sizeof(char), len, f) == len)
-					{
-						putc ('\n', f);
-					}
-				enchant_unlock_file (f);
-				fclose (f);
-			}	
-	}
+	if (generation != NULL)
+		*generation = followed ? pwl->generation : 0;
+	enchant_pwl_unlock(pwl);
 }
 
 void enchant_pwl_remove(EnchantPWL *pwl,
 			 const char *const word, size_t len)
 {
-	if(enchant_pwl_check(pwl, word, len) == 1)
+	enchant_pwl_remove_many(pwl, &word, &len, 1, NULL);
+}
+
+void enchant_pwl_remove_many(EnchantPWL *pwl, const char *const *words,
+			     const size_t *lens, size_t n_words, uint64_t *generation)
+{
+	enchant_pwl_lock(pwl);
+
+	/* Save reading the file again when none of the words is in the list */
+	enchant_pwl_refresh_if_due(pwl);
+	size_t i;
+	for (i = 0; i < n_words && !enchant_pwl_contains(pwl, words[i], lens[i]); i++)
+		;
+	if (i == n_words) {
+		if (generation != NULL && *generation != pwl->generation)
+			*generation = 0;
+		enchant_pwl_unlock(pwl);
 		return;
+	}
 
 	enchant_pwl_refresh_from_file(pwl);
+	gboolean followed = generation != NULL && *generation == pwl->generation;
+
+	GString *lines = g_string_new(NULL);
+	guint32 n_removed = 0;
+	for (i = 0; i < n_words; i++)
+		if (enchant_pwl_remove_from_trie(pwl, words[i], lens[i])) {
+			g_string_append(lines, ENCHANT_PWL_TOMBSTONE);
+			g_string_append_len(lines, words[i], lens[i]);
+			g_string_append_c(lines, '\n');
+			n_removed++;
+		}
+
+	if (lines->len > 0 && pwl->filename != NULL && !pwl->read_only &&
+	    enchant_pwl_append_lines(pwl, lines->str, lines->len)) {
+		/* the tombstones and the lines they cancel */
+		pwl->dead_lines += 2 * n_removed;
+		enchant_pwl_compact_if_due(pwl);
+	}
+	g_string_free(lines, TRUE);
 
-	enchant_pwl_remove_from_trie(pwl, word, len);
+	if (generation != NULL)
+		*generation = followed ? pwl->generation : 0;
+	enchant_pwl_unlock(pwl);
+}
 
-	if (pwl->filename)
-		{
-			char * contents;
-			size_t length;
+uint64_t enchant_pwl_get_generation(EnchantPWL *pwl)
+{
+	g_return_val_if_fail (pwl != NULL, 0);
 
-			if(!g_file_get_contents(pwl->filename, &contents, &length, NULL))
-				return;
+	enchant_pwl_lock(pwl);
+	enchant_pwl_refresh_if_due(pwl);
+	guint64 generation = pwl->generation;
+	enchant_pwl_unlock(pwl);
 
-			FILE *f = g_fopen(pwl->filename, "wb"); /*binary because g_file_get_contents reads binary*/
-			if (f)
-				{
-					enchant_lock_file (f);
-					char *key = g_strndup(word, len);
-
-					char *filestart;
-					if(BOM == g_utf8_get_char(contents))
-						{
-							filestart = g_utf8_next_char(contents);
-							fwrite (contents, sizeof(char), filestart-contents, f);
-						}
-					else
-						filestart = contents;
-
-					char *searchstart = filestart;
-					for(;;)
-						{
-							/*find word*/
-							char *needle = strstr(searchstart, key);
-							if(needle == NULL)
-								{
-									fwrite (searchstart, sizeof(char), length - (searchstart - contents), f);
-									break;
-								}
-							else 
-								{
-									char* foundend = needle+len;
-									if((needle == filestart || contents[needle-contents-1] == '\n' || contents[needle-contents-1] == '\r') &&
-										(foundend == contents + length || *foundend == '\n' || *foundend == '\r'))
-										{
-											fwrite (searchstart, sizeof(char), needle - searchstart, f);
-											searchstart = foundend;
-											while (*searchstart == '\n' || *searchstart == '\r')
-												++searchstart;
-										}
-									else {
-										fwrite (searchstart, sizeof(char), needle - searchstart+1, f);
-										searchstart = needle+1;
-									}
-								}
-						}
-					g_free(key);
-					
-					GStatBuf stats;
-					if(g_stat(pwl->filename, &stats)==0)
-						pwl->file_changed = stats.st_mtime;
-
-					enchant_unlock_file (f);
-
-					fclose (f);
-				}	
-			g_free(contents);
-		}
+	return generation;
 }
 
 static int enchant_pwl_contains(EnchantPWL *pwl, const char *const word, size_t len)
 {
-	int count = 0;
-	EnchantTrieMatcher *matcher = enchant_trie_matcher_init(word, len, 0, case_sensitive, enchant_pwl_check_cb,
-								&count);
-	enchant_trie_find_matches(pwl->trie,matcher);
-	enchant_trie_matcher_free(matcher);
+	char *normalized_word = g_utf8_normalize(word, len, G_NORMALIZE_NFD);
+	int contains = enchant_pwl_contains_normalized(pwl, normalized_word,
+						       enchant_pwl_filter_hash(normalized_word));
+	g_free(normalized_word);
 
-	return count != 0;
+	return contains;
 }
 
 static int enchant_is_all_caps(const char*const word, size_t len)
@@ -525,10 +2324,78 @@ static gchar* enchant_utf8_strtitle(const gchar*str, gssize len)
 	return result;
 }
 
-int enchant_pwl_check(EnchantPWL *pwl, const char *const word, size_t len)
+/* Put the NFD normalization of word, as far as it does not depend on the
+ * case of its characters, in chars.
+ * Returns: the number of characters, or -1 if there are more than max */
+static glong enchant_utf8_decompose(const char *const word, size_t len, gunichar *chars, glong max)
 {
-	enchant_pwl_refresh_from_file(pwl);
+	glong n = 0;
+	for (const char *p = word; p < word + len; p = g_utf8_next_char(p)) {
+		gunichar ch = g_utf8_get_char(p);
+		if (ch < 0x80) {
+			if (n == max)
+				return -1;
+			chars[n++] = ch;
+			continue;
+		}
+
+		gunichar decomposition[G_UNICHAR_MAX_DECOMPOSITION_LENGTH];
+		gsize n_decomposition = g_unichar_fully_decompose(ch, FALSE, decomposition,
+								 G_N_ELEMENTS(decomposition));
+		if (n + (glong)n_decomposition > max)
+			return -1;
+
+		/* Put combining marks in canonical order */
+		for (gsize i = 0; i < n_decomposition; i++) {
+			gunichar mark = decomposition[i];
+			int mark_class = g_unichar_combining_class(mark);
+			glong j = n++;
+			if (mark_class != 0)
+				for (; j > 0 && g_unichar_combining_class(chars[j - 1]) > mark_class; j--)
+					chars[j] = chars[j - 1];
+			chars[j] = mark;
+		}
+	}
+	return n;
+}
 
+/* Returns: whether changing the case of a word is the same as changing the
+ * case of each of its characters, as enchant_pwl_check assumes when it
+ * looks up the lower and title case forms of a word */
+static gboolean enchant_has_simple_case(const gunichar *chars, glong n)
+{
+	/* g_utf8_strdown and g_utf8_strup treat "i" specially in these */
+	const char *locale = setlocale(LC_CTYPE, NULL);
+	if (locale != NULL &&
+	    (g_str_has_prefix(locale, "tr") || g_str_has_prefix(locale, "az") ||
+	     g_str_has_prefix(locale, "lt")))
+		return FALSE;
+
+	for (glong i = 0; i < n; i++)
+		switch (chars[i]) {
+		case 0x0130: /* LATIN CAPITAL LETTER I WITH DOT ABOVE lowers to two characters */
+		case 0x0345: /* COMBINING GREEK YPOGEGRAMMENI uppers to a letter */
+		case 0x03a3: /* GREEK CAPITAL LETTER SIGMA lowers by position */
+			return FALSE;
+		default:
+			break;
+		}
+	return TRUE;
+}
+
+static void enchant_pwl_lookup_add_form(EnchantPWLLookup *lookup, const gunichar *chars, glong n)
+{
+	char *p = lookup->forms[lookup->n_forms];
+	for (glong i = 0; i < n; i++)
+		p += g_unichar_to_utf8(chars[i], p);
+	*p = '\0';
+	lookup->hashes[lookup->n_forms++] = enchant_pwl_filter_hash_chars(chars, n);
+}
+
+/* Look a word up as it is and, if it is in title case or all caps, in lower
+ * and title case too, allocating the forms of the word */
+static int enchant_pwl_check_allocating(EnchantPWL *pwl, const char *const word, size_t len)
+{
 	int exists = enchant_pwl_contains(pwl, word, len);
 	
 	if(exists)
@@ -556,11 +2423,86 @@ int enchant_pwl_check(EnchantPWL *pwl, const char *const word, size_t len)
 	return 1; /* not found */
 }
 
-/* matcher callback when a match is found*/
-static void enchant_pwl_check_cb(char* match,EnchantTrieMatcher* matcher)
+/* Put the forms of a word enchant_pwl_check looks for in lookup, encoded
+ * and hashed, so that they can be looked up in several PWLs */
+static void enchant_pwl_lookup_init(EnchantPWLLookup *lookup, const char *const word, size_t len)
 {
-	g_free(match);
-	(*((int*)(matcher->cbdata)))++;
+	lookup->word = word;
+	lookup->len = len;
+
+	gunichar chars[ENCHANT_PWL_CHECK_MAX_CHARS];
+	glong n = enchant_utf8_decompose(word, len, chars, G_N_ELEMENTS(chars));
+	lookup->n_forms = -1;
+	if (n < 0)
+		return;
+
+	int isAllCaps = 0;
+	gboolean other_forms = enchant_is_title_case(word, len) || (isAllCaps = enchant_is_all_caps(word, len));
+	if (other_forms && !enchant_has_simple_case(chars, n))
+		return;
+
+	lookup->n_forms = 0;
+	enchant_pwl_lookup_add_form(lookup, chars, n);
+	if (other_forms)
+		{
+			gunichar first = chars[0];
+			for (glong i = 0; i < n; i++)
+				chars[i] = g_unichar_tolower(chars[i]);
+			enchant_pwl_lookup_add_form(lookup, chars, n);
+
+			if(isAllCaps)
+			{
+				chars[0] = g_unichar_totitle(first);
+				enchant_pwl_lookup_add_form(lookup, chars, n);
+			}
+		}
+}
+
+static int enchant_pwl_check_locked(EnchantPWL *pwl, const EnchantPWLLookup *lookup)
+{
+	enchant_pwl_refresh_if_due(pwl);
+
+	if (lookup->n_forms < 0)
+		return enchant_pwl_check_allocating(pwl, lookup->word, lookup->len);
+
+	for (int i = 0; i < lookup->n_forms; i++)
+		if (enchant_pwl_contains_normalized(pwl, lookup->forms[i], lookup->hashes[i]))
+			return 0;
+
+	return 1; /* not found */
+}
+
+int enchant_pwl_check(EnchantPWL *pwl, const char *const word, size_t len)
+{
+	EnchantPWLLookup lookup;
+	enchant_pwl_lookup_init(&lookup, word, len);
+
+	enchant_pwl_lock(pwl);
+	int result = enchant_pwl_check_locked(pwl, &lookup);
+	enchant_pwl_unlock(pwl);
+
+	return result;
+}
+
+int enchant_pwl_check_with_exclude(EnchantPWL *pwl, EnchantPWL *exclude,
+				   const char *const word, size_t len)
+{
+	EnchantPWLLookup lookup;
+	enchant_pwl_lookup_init(&lookup, word, len);
+
+	if (exclude != NULL) {
+		enchant_pwl_lock(exclude);
+		int excluded = enchant_pwl_check_locked(exclude, &lookup);
+		enchant_pwl_unlock(exclude);
+		if (excluded == 0)
+			return 1;
+	}
+
+	enchant_pwl_lock(pwl);
+	int result = enchant_pwl_check_locked(pwl, &lookup);
+	enchant_pwl_unlock(pwl);
+
+	return result == 0 ? 0 : -1;
 }
 
 static void enchant_pwl_case_and_denormalize_suggestions(EnchantPWL *pwl, 
@@ -575,7 +2517,7 @@ static void enchant_pwl_case_and_denormalize_suggestions(EnchantPWL *pwl,
 	
 	for (size_t i = 0; i < suggs_list->n_suggs; ++i)
 		{
-			gchar* suggestion = g_hash_table_lookup (pwl->words_in_trie, suggs_list->suggs[i]);
+			const gchar* suggestion = enchant_pwl_lookup_original (pwl, suggs_list->suggs[i]);
 			size_t suggestion_len = strlen(suggestion);
 
 			gchar* cased_suggestion;
@@ -589,16 +2531,19 @@ static void enchant_pwl_case_and_denormalize_suggestions(EnchantPWL *pwl,
 		}
 }
 
-static int best_distance(char** suggs, const char *const word, size_t len)
+/* suggs are normalized already if normalized, else each is normalized here */
+static int best_distance(char** suggs, gboolean normalized, const char *const word, size_t len)
 {
 	char *normalized_word = g_utf8_normalize (word, len, G_NORMALIZE_NFD);
-	int best_dist = g_utf8_strlen(normalized_word, -1);
+	int best_dist = MIN (g_utf8_strlen(normalized_word, -1), ENCHANT_PWL_MAX_ERRORS);
 
 	for (char **sugg_it = suggs; *sugg_it; ++sugg_it)
 		{
-			char* normalized_sugg = g_utf8_normalize (*sugg_it, -1, G_NORMALIZE_NFD);
-			int dist = edit_dist(normalized_word, normalized_sugg);
-			g_free(normalized_sugg);
+			char* normalized_sugg = normalized ? *sugg_it :
+				g_utf8_normalize (*sugg_it, -1, G_NORMALIZE_NFD);
+			int dist = edit_dist(normalized_word, normalized_sugg, best_dist);
+			if (!normalized)
+				g_free(normalized_sugg);
 			best_dist = MIN (dist, best_dist);
 		}
 
@@ -611,21 +2556,61 @@ static int best_distance(char** suggs, const char *const word, size_t len)
 char** enchant_pwl_suggest(EnchantPWL *pwl, const char *const word,
 			   size_t len, char** suggs, size_t* out_n_suggs)
 {
-	int max_dist = suggs ? best_distance(suggs, word, len) : ENCHANT_PWL_MAX_ERRORS;
+	int max_dist = suggs ? best_distance(suggs, FALSE, word, len) : ENCHANT_PWL_MAX_ERRORS;
+	return enchant_pwl_suggest_within(pwl, word, len, max_dist, out_n_suggs);
+}
+
+char** enchant_pwl_suggest_normalized(EnchantPWL *pwl, const char *const word,
+				      size_t len, char** normalized_suggs, size_t* out_n_suggs)
+{
+	int max_dist = normalized_suggs ? best_distance(normalized_suggs, TRUE, word, len) :
+		ENCHANT_PWL_MAX_ERRORS;
+	return enchant_pwl_suggest_within(pwl, word, len, max_dist, out_n_suggs);
+}
+
+static char** enchant_pwl_suggest_within(EnchantPWL *pwl, const char *const word,
+					 size_t len, int max_dist, size_t* out_n_suggs)
+{
 	max_dist = MIN (max_dist, ENCHANT_PWL_MAX_ERRORS);
 
-	enchant_pwl_refresh_from_file(pwl);
+	enchant_pwl_lock(pwl);
+	enchant_pwl_refresh_if_due(pwl);
 
 	EnchantSuggList sugg_list;
 	sugg_list.suggs = g_new0(char*,ENCHANT_PWL_MAX_SUGGS+1);
 	sugg_list.sugg_errs = g_new0(int,ENCHANT_PWL_MAX_SUGGS);
 	sugg_list.n_suggs = 0;
+	sugg_list.folded_words = NULL;
 
 	EnchantTrieMatcher *matcher = enchant_trie_matcher_init(word, len, max_dist,
 								case_insensitive,
 								enchant_pwl_suggest_cb,
 								&sugg_list);
-	enchant_trie_find_matches(pwl->trie,matcher);
+
+	/* Past an edit for every other character, what is left of the word
+	 * matches near any short entry */
+	max_dist = MIN (max_dist, (int) MAX (1, (matcher->word_len + 1) / 2));
+
+	/* Only the closest matches are kept, so a wider search is needed only
+	 * while nothing has been found; most misspellings are a single edit
+	 * away, and a narrow search visits far fewer nodes */
+	int radius = MIN (1, max_dist);
+	EnchantPWLDeletions *deletions = enchant_pwl_get_deletions(pwl);
+	if (deletions != NULL)
+		for (; sugg_list.n_suggs == 0 && radius <= MIN (max_dist, ENCHANT_PWL_DELETIONS_MAX); radius++) {
+			matcher->max_errors = radius;
+			enchant_pwl_deletions_find_matches(deletions, matcher);
+		}
+	if (sugg_list.n_suggs == 0 && radius <= max_dist) {
+		EnchantTrie *folded_trie = enchant_pwl_get_folded_trie(pwl);
+		sugg_list.folded_words = pwl->folded_words;
+		matcher->cbfunc = enchant_pwl_suggest_folded_cb;
+		for (; sugg_list.n_suggs == 0 && radius <= max_dist; radius++) {
+			matcher->max_errors = matcher->band = radius;
+			enchant_trie_find_matches(folded_trie,matcher);
+		}
+	}
+	pwl->visited_nodes += matcher->visited_nodes;
 	enchant_trie_matcher_free(matcher);
 
 	g_free(sugg_list.sugg_errs);
@@ -633,10 +2618,22 @@ char** enchant_pwl_suggest(EnchantPWL *pwl, const char *const word,
 	(*out_n_suggs) = sugg_list.n_suggs;
 
 	enchant_pwl_case_and_denormalize_suggestions(pwl, word, len, &sugg_list);
+	enchant_pwl_unlock(pwl);
 	
 	return sugg_list.suggs;
 }
 
+size_t enchant_pwl_get_visited_nodes(EnchantPWL *pwl)
+{
+	g_return_val_if_fail (pwl != NULL, 0);
+
+	enchant_pwl_lock(pwl);
+	size_t visited_nodes = pwl->visited_nodes;
+	enchant_pwl_unlock(pwl);
+
+	return visited_nodes;
+}
+
 /* matcher callback when a match is found*/
 static void enchant_pwl_suggest_cb(char* match,EnchantTrieMatcher* matcher)
 {
@@ -679,269 +2676,1022 @@ static void enchant_pwl_suggest_cb(char* match,EnchantTrieMatcher* matcher)
 	sugg_list->n_suggs = sugg_list->n_suggs + changes;
 }
 
-static void enchant_trie_free(EnchantTrie* trie)
+typedef struct {
+	GString *strings;
+	GArray *words;
+} EnchantPWLDeletionsBuilder;
+
+/* Add a word, and its case folded form if different, to the strings */
+static void enchant_pwl_deletions_collect(const char *word, gpointer data)
 {
-	/* Don't try to free NULL or the EOSTrie pointer */
-	if(trie == NULL || trie == EOSTrie) {
-		return;
+	EnchantPWLDeletionsBuilder *builder = data;
+	GString *strings = builder->strings;
+
+	guint32 offset = strings->len;
+	g_array_append_val(builder->words, offset);
+	g_string_append_len(strings, word, strlen(word) + 1);
+	gsize folded = strings->len;
+	for (const char *p = word; *p; p = g_utf8_next_char(p))
+		g_string_append_unichar(strings, enchant_unichar_fold(g_utf8_get_char(p)));
+	if (strcmp(strings->str + offset, strings->str + folded) == 0)
+		g_string_truncate(strings, folded);
+	g_string_append_c(strings, '\0');
+}
+
+/* Returns: the case folded form of a word of the index */
+static const char* enchant_pwl_deletions_folded(const EnchantPWLDeletions* deletions, guint32 word)
+{
+	const char *s = deletions->strings + deletions->words[word];
+	const char *folded = s + strlen(s) + 1;
+	return *folded ? folded : s;
+}
+
+/* Hash of the first len characters of chars, except those at skip1 and skip2 */
+static guint32 enchant_pwl_deletions_hash(const gunichar* chars, glong len, glong skip1, glong skip2)
+{
+	guint32 hash = 2166136261u;
+	for (glong i = 0; i < len; i++)
+		if (i != skip1 && i != skip2)
+			hash = (hash ^ chars[i]) * 16777619u;
+
+	/* The buckets are chosen by the low bits, so mix in the high ones */
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	return hash;
+}
+
+/* Compute the hashes of the strings made by deleting up to max_deletions
+ * characters from the start of a word of len characters, and sort them.
+ * Returns: how many distinct hashes there are */
+static int enchant_pwl_deletions_variants(const gunichar* chars, glong len, int max_deletions,
+					  guint32* hashes)
+{
+	len = MIN (len, ENCHANT_PWL_DELETIONS_PREFIX);
+	int n = 0;
+	hashes[n++] = enchant_pwl_deletions_hash(chars, len, -1, -1);
+	for (glong i = 0; max_deletions >= 1 && i < len; i++) {
+		hashes[n++] = enchant_pwl_deletions_hash(chars, len, i, -1);
+		for (glong j = i + 1; max_deletions >= 2 && j < len; j++)
+			hashes[n++] = enchant_pwl_deletions_hash(chars, len, i, j);
+	}
+
+	/* Deleting either of two equal characters gives the same string */
+	for (int i = 1; i < n; i++) {
+		guint32 hash = hashes[i];
+		int j = i;
+		for (; j > 0 && hashes[j - 1] > hash; j--)
+			hashes[j] = hashes[j - 1];
+		hashes[j] = hash;
 	}
+	int n_distinct = 0;
+	for (int i = 0; i < n; i++)
+		if (i == 0 || hashes[i] != hashes[i - 1])
+			hashes[n_distinct++] = hashes[i];
+	return n_distinct;
+}
+
+/* Decode the start of a word that the deletion index looks at */
+static glong enchant_pwl_deletions_decode(const char* word, gunichar* chars)
+{
+	glong len = 0;
+	for (const char *p = word; *p && len < ENCHANT_PWL_DELETIONS_PREFIX; p = g_utf8_next_char(p))
+		chars[len++] = g_utf8_get_char(p);
+	return len;
+}
 
-	/* Because we have not set a destroy function for the hashtable
-	 * (to make code cleaner below), we need to explicitly free all
-	 * subtries with a callback function.
-	 */
-	if (trie->subtries != NULL) {
-		g_hash_table_foreach(trie->subtries,enchant_trie_free_cb,NULL);
-		g_hash_table_destroy(trie->subtries);
+static EnchantPWLDeletions* enchant_pwl_deletions_new(EnchantTrie* trie)
+{
+	EnchantPWLDeletions *deletions = g_new0(EnchantPWLDeletions, 1);
+
+	EnchantPWLDeletionsBuilder builder;
+	builder.strings = g_string_new(NULL);
+	builder.words = g_array_new(FALSE, FALSE, sizeof(guint32));
+	enchant_trie_foreach_word(trie, enchant_pwl_deletions_collect, &builder);
+	deletions->n_words = builder.words->len;
+	deletions->words = (guint32 *)g_array_free(builder.words, FALSE);
+	deletions->strings = g_string_free(builder.strings, FALSE);
+
+	/* Hash the variants of each word once, count them by bucket, then lay
+	 * the words out by bucket */
+	GArray *hashes = g_array_new(FALSE, FALSE, sizeof(guint32));
+	guint8 *n_hashes = g_new(guint8, deletions->n_words);
+	for (guint32 w = 0; w < deletions->n_words; w++) {
+		gunichar chars[ENCHANT_PWL_DELETIONS_PREFIX];
+		guint32 variants[ENCHANT_PWL_DELETIONS_VARIANTS];
+		glong len = enchant_pwl_deletions_decode(enchant_pwl_deletions_folded(deletions, w), chars);
+		n_hashes[w] = enchant_pwl_deletions_variants(chars, len, ENCHANT_PWL_DELETIONS_MAX, variants);
+		g_array_append_vals(hashes, variants, n_hashes[w]);
 	}
 
-	g_free(trie->value);
-	g_free(trie);
+	deletions->n_entries = hashes->len;
+	deletions->n_buckets = 1;
+	while (deletions->n_buckets < deletions->n_entries)
+		deletions->n_buckets *= 2;
+	const guint32 mask = deletions->n_buckets - 1;
+
+	deletions->buckets = g_new0(guint32, deletions->n_buckets + 1);
+	for (guint32 e = 0; e < deletions->n_entries; e++)
+		deletions->buckets[g_array_index(hashes, guint32, e) & mask]++;
+	for (guint32 b = 1; b <= deletions->n_buckets; b++)
+		deletions->buckets[b] += deletions->buckets[b - 1];
+
+	/* Filling from the end leaves each bucket's offset at its start, and
+	 * its words in order */
+	deletions->entries = g_new(guint32, MAX (deletions->n_entries, 1));
+	guint32 e = deletions->n_entries;
+	for (guint32 w = deletions->n_words; w-- > 0; )
+		for (int i = 0; i < n_hashes[w]; i++) {
+			guint32 bucket = g_array_index(hashes, guint32, --e) & mask;
+			deletions->entries[--deletions->buckets[bucket]] = w;
+		}
+	g_free(n_hashes);
+	g_array_free(hashes, TRUE);
+
+	deletions->seen = g_new0(guint32, MAX (deletions->n_words, 1));
+	return deletions;
 }
 
-static void enchant_trie_free_cb(void* key _GL_UNUSED_PARAMETER,
-				 void* value,
-				 void* data _GL_UNUSED_PARAMETER)
+static void enchant_pwl_deletions_free(EnchantPWLDeletions* deletions)
 {
-	enchant_trie_free((EnchantTrie*) value);
+	if (deletions == NULL)
+		return;
+
+	g_free(deletions->buckets);
+	g_free(deletions->entries);
+	g_free(deletions->words);
+	g_free(deletions->strings);
+	g_free(deletions->seen);
+	g_free(deletions);
 }
 
-static EnchantTrie* enchant_trie_insert(EnchantTrie* trie,const char *const word)
+/* Report the words of the index within max_errors of the word, for
+ * max_errors up to ENCHANT_PWL_DELETIONS_MAX */
+static void enchant_pwl_deletions_find_matches(EnchantPWLDeletions* deletions,
+					       EnchantTrieMatcher *matcher)
 {
-	if (trie == NULL) {
-		trie = g_new0(EnchantTrie, 1);
+	guint32 hashes[ENCHANT_PWL_DELETIONS_VARIANTS];
+	int n_hashes = enchant_pwl_deletions_variants(matcher->word, matcher->word_len,
+						      matcher->max_errors, hashes);
+	char *word = g_ucs4_to_utf8(matcher->word, matcher->word_len, NULL, NULL, NULL);
+
+	if (++deletions->query == 0) {
+		memset(deletions->seen, 0, MAX (deletions->n_words, 1) * sizeof(guint32));
+		deletions->query = 1;
 	}
 
-	if (trie->value == NULL) {
-		if (trie->subtries == NULL) {
-			/*  When single word, store in trie->value */
-			trie->value = g_strdup(word);
-		} else {
-			/* Store multiple words in subtries */
-			if (word[0] == '\0') {
-				/* Mark end-of-string with special node */
-				char *tmpWord = g_strdup("");
-				g_hash_table_insert(trie->subtries, tmpWord, EOSTrie);
-			} else {
-				ssize_t nxtCh = (ssize_t)(g_utf8_next_char(word)-word);
-				char *tmpWord = g_strndup(word,nxtCh);
-				EnchantTrie* subtrie = g_hash_table_lookup(trie->subtries, tmpWord);
-				subtrie = enchant_trie_insert(subtrie, word + nxtCh);
-				g_hash_table_insert(trie->subtries, tmpWord, subtrie);
+	const guint32 mask = deletions->n_buckets - 1;
+	for (int h = 0; h < n_hashes; h++) {
+		guint32 bucket = hashes[h] & mask;
+		for (guint32 e = deletions->buckets[bucket]; e < deletions->buckets[bucket + 1]; e++) {
+			guint32 w = deletions->entries[e];
+			if (deletions->seen[w] == deletions->query)
+				continue;
+			deletions->seen[w] = deletions->query;
+			matcher->visited_nodes++;
+
+			int dist = edit_dist(word, enchant_pwl_deletions_folded(deletions, w), matcher->max_errors);
+			if (dist <= matcher->max_errors) {
+				matcher->num_errors = dist;
+				matcher->cbfunc(g_strdup(deletions->strings + deletions->words[w]), matcher);
 			}
 		}
-	} else {
-		/* Create new hash table for subtries, and reinsert */
-		trie->subtries = g_hash_table_new_full(g_str_hash, 
-						       g_str_equal, g_free, NULL);
-		char *tmpWord = trie->value;
-		trie->value = NULL;
-		enchant_trie_insert(trie, tmpWord);
-		enchant_trie_insert(trie, word);
-		g_free(tmpWord);
 	}
 
+	g_free(word);
+}
+
+/* matcher callback when a match is found in the trie of case folded words */
+static void enchant_pwl_suggest_folded_cb(char* match,EnchantTrieMatcher* matcher)
+{
+	EnchantSuggList *sugg_list = (EnchantSuggList*)(matcher->cbdata);
+	GSList *words = g_hash_table_lookup(sugg_list->folded_words, match);
+	if (words == NULL) {
+		/* The form only stands for itself */
+		enchant_pwl_suggest_cb(match, matcher);
+		return;
+	}
+	g_free(match);
+
+	for (GSList *l = words; l != NULL; l = l->next)
+		enchant_pwl_suggest_cb(g_strdup(l->data), matcher);
+}
+
+static EnchantTrie* enchant_trie_new(void)
+{
+	EnchantTrie *trie = g_new0(EnchantTrie, 1);
+	enchant_trie_clear(trie);
 	return trie;
 }
 
-static void enchant_trie_remove(EnchantTrie* trie,const char *const word)
+static void enchant_trie_free(EnchantTrie* trie)
+{
+	if (!trie->read_only || trie->minimized) {
+		g_free(trie->nodes);
+		g_free(trie->edges);
+		g_free(trie->strings);
+	}
+	g_free(trie);
+}
+
+/* Empty the trie, keeping its memory for reuse */
+static void enchant_trie_clear(EnchantTrie* trie)
+{
+	if (trie->read_only) {
+		if (trie->minimized) {
+			g_free(trie->nodes);
+			g_free(trie->edges);
+			g_free(trie->strings);
+		}
+		trie->nodes = NULL;
+		trie->edges = NULL;
+		trie->edges_size = 0;
+		trie->strings = NULL;
+		trie->strings_size = 0;
+		trie->read_only = FALSE;
+		trie->minimized = FALSE;
+	}
+
+	if (trie->nodes == NULL) {
+		trie->nodes_size = 16;
+		trie->nodes = g_new(EnchantTrieNode, trie->nodes_size);
+	}
+
+	/* The end-of-string node has neither value nor edges */
+	trie->nodes[ENCHANT_TRIE_EOS].value = ENCHANT_TRIE_NONE;
+	trie->nodes[ENCHANT_TRIE_EOS].edges = ENCHANT_TRIE_NONE;
+	trie->nodes[ENCHANT_TRIE_EOS].n_edges = 0;
+	trie->nodes[ENCHANT_TRIE_EOS].edges_size = 0;
+	trie->n_nodes = 1;
+	trie->free_nodes = ENCHANT_TRIE_NONE;
+
+	trie->n_edges = 0;
+	for (int i = 0; i < ENCHANT_TRIE_EDGE_CLASSES; i++)
+		trie->free_edges[i] = ENCHANT_TRIE_NONE;
+
+	trie->n_strings = 0;
+	trie->strings_garbage = 0;
+
+	trie->root = ENCHANT_TRIE_NONE;
+}
+
+static void enchant_trie_insert_word(const char *word, gpointer data)
+{
+	enchant_trie_insert(data, word);
+}
+
+/* Copy the arrays of a read-only trie, or rebuild a minimized trie as an
+ * ordinary one, so that it can be modified */
+static void enchant_trie_unshare(EnchantTrie* trie)
 {
-	if (trie == NULL)
+	if (!trie->read_only)
 		return;
 
-	if (trie->value == NULL) {
-		if (trie->subtries != NULL) {
-			/* Store multiple words in subtries */
-			if (word[0] == '\0') {
-				/* End-of-string is marked with special node */
-				g_hash_table_remove(trie->subtries, "");
-			} else {
-				ssize_t nxtCh = (ssize_t)(g_utf8_next_char(word) - word);
-				char *tmpWord = g_strndup(word, nxtCh);
-				EnchantTrie *subtrie = g_hash_table_lookup(trie->subtries, tmpWord);
-				enchant_trie_remove(subtrie, word + nxtCh);
-
-				if(subtrie->subtries == NULL && subtrie->value == NULL) {
-					g_hash_table_remove(trie->subtries, tmpWord);
-					enchant_trie_free (subtrie);
-				}
+	if (trie->minimized) {
+		EnchantTrie *unshared = enchant_trie_new();
+		enchant_trie_foreach_word(trie, enchant_trie_insert_word, unshared);
+		g_free(trie->nodes);
+		g_free(trie->edges);
+		g_free(trie->strings);
+		*trie = *unshared;
+		g_free(unshared);
+		return;
+	}
 
-				g_free(tmpWord);
-			}
+	EnchantTrieNode *nodes = g_new(EnchantTrieNode, trie->nodes_size);
+	memcpy(nodes, trie->nodes, trie->n_nodes * sizeof(EnchantTrieNode));
+	trie->nodes = nodes;
 
-			if(g_hash_table_size(trie->subtries) == 1)
-				{
-					GList* keys = g_hash_table_get_keys(trie->subtries);
-					char *key = (char*) keys->data;
-					EnchantTrie *subtrie = g_hash_table_lookup(trie->subtries, key);
-
-					/* only remove trie nodes that have values by propagating these up */
-					if(subtrie->value)
-						{
-							trie->value = g_strconcat(key, subtrie->value, NULL);
-							enchant_trie_free(subtrie);
-							g_hash_table_destroy(trie->subtries);
-							trie->subtries = NULL;
-						}
-
-					g_list_free(keys);
-				}
+	EnchantTrieEdge *edges = NULL;
+	if (trie->edges_size > 0) {
+		edges = g_new(EnchantTrieEdge, trie->edges_size);
+		memcpy(edges, trie->edges, trie->n_edges * sizeof(EnchantTrieEdge));
+	}
+	trie->edges = edges;
+
+	char *strings = g_new(char, trie->strings_size);
+	memcpy(strings, trie->strings, trie->n_strings);
+	trie->strings = strings;
+
+	trie->read_only = FALSE;
+}
+
+static guint32 enchant_trie_node_new(EnchantTrie* trie)
+{
+	guint32 node = trie->free_nodes;
+	if (node != ENCHANT_TRIE_NONE)
+		trie->free_nodes = trie->nodes[node].n_edges;
+	else {
+		if (trie->n_nodes == trie->nodes_size) {
+			trie->nodes_size *= 2;
+			trie->nodes = g_renew(EnchantTrieNode, trie->nodes, trie->nodes_size);
 		}
-	} else {
-		if(strcmp(trie->value, word) == 0)
-		{
-			g_free(trie->value);
-			trie->value = NULL;
+		node = trie->n_nodes++;
+	}
+
+	trie->nodes[node].value = ENCHANT_TRIE_NONE;
+	trie->nodes[node].edges = ENCHANT_TRIE_NONE;
+	trie->nodes[node].n_edges = 0;
+	trie->nodes[node].edges_size = 0;
+	return node;
+}
+
+static guint32 enchant_trie_edges_new(EnchantTrie* trie, int size_class)
+{
+	guint32 edges = trie->free_edges[size_class];
+	if (edges != ENCHANT_TRIE_NONE) {
+		/* Unused blocks are linked through their first edge */
+		trie->free_edges[size_class] = trie->edges[edges].node;
+		return edges;
+	}
+
+	guint32 size = 1u << size_class;
+	if (trie->n_edges + size > trie->edges_size) {
+		trie->edges_size = MAX (trie->edges_size * 2, trie->n_edges + size);
+		trie->edges = g_renew(EnchantTrieEdge, trie->edges, trie->edges_size);
+	}
+	edges = trie->n_edges;
+	trie->n_edges += size;
+	return edges;
+}
+
+static void enchant_trie_edges_free(EnchantTrie* trie, guint32 edges, guint32 size)
+{
+	int size_class = g_bit_storage(size) - 1;
+	trie->edges[edges].node = trie->free_edges[size_class];
+	trie->free_edges[size_class] = edges;
+}
+
+static void enchant_trie_node_free(EnchantTrie* trie, guint32 node)
+{
+	EnchantTrieNode *n = &trie->nodes[node];
+	if (n->edges_size != 0)
+		enchant_trie_edges_free(trie, n->edges, n->edges_size);
+	if (n->value != ENCHANT_TRIE_NONE)
+		trie->strings_garbage += strlen(trie->strings + n->value) + 1;
+
+	n->value = ENCHANT_TRIE_NONE;
+	n->edges = ENCHANT_TRIE_NONE;
+	n->edges_size = 0;
+	n->n_edges = trie->free_nodes;
+	trie->free_nodes = node;
+}
+
+/* Store the concatenation of prefix and suffix in the string pool,
+ * returning its offset.  suffix may point into the pool itself. */
+static guint32 enchant_trie_add_string(EnchantTrie* trie, const char *prefix, size_t prefix_len,
+				       const char *suffix)
+{
+	gsize suffix_offset = 0;
+	gboolean suffix_in_pool = trie->strings != NULL &&
+		suffix >= trie->strings && suffix < trie->strings + trie->n_strings;
+	if (suffix_in_pool)
+		suffix_offset = suffix - trie->strings;
+
+	size_t suffix_len = strlen(suffix);
+	gsize needed = trie->n_strings + prefix_len + suffix_len + 1;
+	if (needed > trie->strings_size) {
+		trie->strings_size = MAX (trie->strings_size * 2, MAX (needed, 256));
+		trie->strings = g_renew(char, trie->strings, trie->strings_size);
+		if (suffix_in_pool)
+			suffix = trie->strings + suffix_offset;
+	}
+
+	guint32 offset = (guint32)trie->n_strings;
+	memcpy(trie->strings + offset, prefix, prefix_len);
+	memcpy(trie->strings + offset + prefix_len, suffix, suffix_len + 1);
+	trie->n_strings = needed;
+	return offset;
+}
+
+/* Rewrite the string pool without the strings of removed words, once
+ * they make up most of it. */
+static void enchant_trie_compact_strings(EnchantTrie* trie)
+{
+	if (trie->strings_garbage < 4096 || trie->strings_garbage < trie->n_strings / 2)
+		return;
+
+	char *strings = g_new(char, trie->n_strings - trie->strings_garbage);
+	gsize n_strings = 0;
+	for (guint32 node = 0; node < trie->n_nodes; node++) {
+		EnchantTrieNode *n = &trie->nodes[node];
+		if (n->value != ENCHANT_TRIE_NONE) {
+			size_t len = strlen(trie->strings + n->value) + 1;
+			memcpy(strings + n_strings, trie->strings + n->value, len);
+			n->value = (guint32)n_strings;
+			n_strings += len;
 		}
 	}
+
+	g_free(trie->strings);
+	trie->strings = strings;
+	trie->strings_size = trie->n_strings - trie->strings_garbage;
+	trie->n_strings = n_strings;
+	trie->strings_garbage = 0;
 }
 
-static EnchantTrie* enchant_trie_get_subtrie(EnchantTrie* trie, 
-					     EnchantTrieMatcher* matcher,
-					     char** nxtChS)
+/* Returns the index of the edge of node labelled ch, or ENCHANT_TRIE_NONE */
+static guint32 enchant_trie_find_edge(const EnchantTrie* trie, guint32 node, gunichar ch)
 {
-	if(trie->subtries == NULL || *nxtChS == NULL)
-		return NULL;
+	const EnchantTrieNode *n = &trie->nodes[node];
+	const EnchantTrieEdge *edges = trie->edges + n->edges;
+	guint32 lo = 0, hi = n->n_edges;
+	while (lo < hi) {
+		guint32 mid = lo + (hi - lo) / 2;
+		if (edges[mid].ch < ch)
+			lo = mid + 1;
+		else if (edges[mid].ch > ch)
+			hi = mid;
+		else
+			return n->edges + mid;
+	}
+	return ENCHANT_TRIE_NONE;
+}
 
-	EnchantTrie *subtrie = g_hash_table_lookup(trie->subtries,*nxtChS);
-	if(subtrie == NULL && matcher->mode == case_insensitive) {
-		char* nxtChSUp = g_utf8_strup(*nxtChS, -1); /* we ignore the title case scenario since that will give us an edit_distance of one which is acceptable since this mode is used for suggestions*/
-		g_free(*nxtChS);
-		*nxtChS = nxtChSUp;
-		subtrie = g_hash_table_lookup(trie->subtries,nxtChSUp);
+/* Map ch to subtrie under node, replacing any existing mapping */
+static void enchant_trie_set_edge(EnchantTrie* trie, guint32 node, gunichar ch, guint32 subtrie)
+{
+	guint32 edge = enchant_trie_find_edge(trie, node, ch);
+	if (edge != ENCHANT_TRIE_NONE) {
+		trie->edges[edge].node = subtrie;
+		return;
+	}
+
+	EnchantTrieNode *n = &trie->nodes[node];
+	if (n->n_edges == n->edges_size) {
+		/* Move the edges to a block twice the size */
+		guint32 size = n->edges_size ? n->edges_size * 2 : 2;
+		guint32 edges = enchant_trie_edges_new(trie, g_bit_storage(size) - 1);
+		n = &trie->nodes[node];
+		if (n->edges_size != 0) {
+			memcpy(trie->edges + edges, trie->edges + n->edges, n->n_edges * sizeof(EnchantTrieEdge));
+			enchant_trie_edges_free(trie, n->edges, n->edges_size);
+		}
+		n->edges = edges;
+		n->edges_size = size;
 	}
-	return subtrie;
+
+	EnchantTrieEdge *edges = trie->edges + n->edges;
+	guint32 i = n->n_edges;
+	for (; i > 0 && edges[i - 1].ch > ch; i--)
+		edges[i] = edges[i - 1];
+	edges[i].ch = ch;
+	edges[i].node = subtrie;
+	n->n_edges++;
 }
 
-static void enchant_trie_find_matches(EnchantTrie* trie,EnchantTrieMatcher *matcher)
+static void enchant_trie_remove_edge(EnchantTrie* trie, guint32 node, gunichar ch)
 {
-	g_return_if_fail(matcher);
+	guint32 edge = enchant_trie_find_edge(trie, node, ch);
+	if (edge == ENCHANT_TRIE_NONE)
+		return;
 
-	/* Can't match in the empty trie */
-	if(trie == NULL) {
+	EnchantTrieNode *n = &trie->nodes[node];
+	guint32 last = n->edges + n->n_edges - 1;
+	memmove(trie->edges + edge, trie->edges + edge + 1, (last - edge) * sizeof(EnchantTrieEdge));
+	n->n_edges--;
+}
+
+static void enchant_trie_insert(EnchantTrie* trie,const char *const word)
+{
+	g_return_if_fail(!trie->read_only);
+
+	if (trie->root == ENCHANT_TRIE_NONE) {
+		trie->root = enchant_trie_node_new(trie);
+		trie->nodes[trie->root].value = enchant_trie_add_string(trie, "", 0, word);
 		return;
 	}
 
-	/* Bail out if over the error limits */
-	if(matcher->num_errors > matcher->max_errors){
+	const char *rest = word;
+	guint32 node = trie->root;
+	for (;;) {
+		EnchantTrieNode *n = &trie->nodes[node];
+		if (n->value != ENCHANT_TRIE_NONE) {
+			/* Replace the single word with a branch, and reinsert it
+			 * in place, reusing its string */
+			guint32 value = n->value;
+			n->value = ENCHANT_TRIE_NONE;
+			const char *old = trie->strings + value;
+			if (*old == '\0') {
+				trie->strings_garbage++;
+				enchant_trie_set_edge(trie, node, 0, ENCHANT_TRIE_EOS);
+			} else {
+				guint32 subtrie = enchant_trie_node_new(trie);
+				gunichar ch = g_utf8_get_char(trie->strings + value);
+				trie->nodes[subtrie].value = (guint32)(g_utf8_next_char(trie->strings + value) - trie->strings);
+				trie->strings_garbage += g_utf8_next_char(trie->strings + value) - (trie->strings + value);
+				enchant_trie_set_edge(trie, node, ch, subtrie);
+			}
+		} else if (n->edges_size == 0) {
+			/*  When single word, store in value */
+			n->value = enchant_trie_add_string(trie, "", 0, rest);
+			return;
+		}
+
+		/* Store multiple words in subtries */
+		if (*rest == '\0') {
+			/* Mark end-of-string with special node */
+			enchant_trie_set_edge(trie, node, 0, ENCHANT_TRIE_EOS);
+			return;
+		}
+
+		gunichar ch = g_utf8_get_char(rest);
+		rest = g_utf8_next_char(rest);
+		guint32 edge = enchant_trie_find_edge(trie, node, ch);
+		if (edge == ENCHANT_TRIE_NONE) {
+			guint32 subtrie = enchant_trie_node_new(trie);
+			trie->nodes[subtrie].value = enchant_trie_add_string(trie, "", 0, rest);
+			enchant_trie_set_edge(trie, node, ch, subtrie);
+			return;
+		}
+		node = trie->edges[edge].node;
+	}
+}
+
+static void enchant_trie_remove_from_node(EnchantTrie* trie, guint32 node, const char *const word)
+{
+	EnchantTrieNode *n = &trie->nodes[node];
+	if (n->value != ENCHANT_TRIE_NONE) {
+		if (strcmp(trie->strings + n->value, word) == 0) {
+			trie->strings_garbage += strlen(word) + 1;
+			n->value = ENCHANT_TRIE_NONE;
+		}
 		return;
 	}
 
-	/* If the end of a string has been reached, no point recursing */
-	if (trie == EOSTrie) {
-		size_t word_len = strlen(matcher->word);
-		int errs = matcher->num_errors;
-		if((ssize_t)word_len > matcher->word_pos) {
-			matcher->num_errors = errs + word_len - matcher->word_pos;
+	if (n->edges_size == 0)
+		return;
+
+	if (word[0] == '\0') {
+		/* End-of-string is marked with special node */
+		enchant_trie_remove_edge(trie, node, 0);
+	} else {
+		gunichar ch = g_utf8_get_char(word);
+		guint32 edge = enchant_trie_find_edge(trie, node, ch);
+		if (edge == ENCHANT_TRIE_NONE)
+			return;
+
+		guint32 subtrie = trie->edges[edge].node;
+		enchant_trie_remove_from_node(trie, subtrie, g_utf8_next_char(word));
+
+		EnchantTrieNode *sub = &trie->nodes[subtrie];
+		if (sub->edges_size == 0 && sub->value == ENCHANT_TRIE_NONE) {
+			enchant_trie_remove_edge(trie, node, ch);
+			enchant_trie_node_free(trie, subtrie);
 		}
-		if (matcher->num_errors <= matcher->max_errors) {
-			matcher->cbfunc(g_strdup(matcher->path),matcher);
+	}
+
+	n = &trie->nodes[node];
+	if (n->n_edges == 1) {
+		EnchantTrieEdge *edge = &trie->edges[n->edges];
+		guint32 subtrie = edge->node;
+
+		/* only remove trie nodes that have values by propagating these up */
+		if (subtrie != ENCHANT_TRIE_EOS && trie->nodes[subtrie].value != ENCHANT_TRIE_NONE) {
+			char key[6];
+			int key_len = g_unichar_to_utf8(edge->ch, key);
+			guint32 value = enchant_trie_add_string(trie, key, key_len,
+								trie->strings + trie->nodes[subtrie].value);
+			enchant_trie_node_free(trie, subtrie);
+
+			n = &trie->nodes[node];
+			enchant_trie_edges_free(trie, n->edges, n->edges_size);
+			n->edges = ENCHANT_TRIE_NONE;
+			n->n_edges = 0;
+			n->edges_size = 0;
+			n->value = value;
 		}
-		matcher->num_errors = errs;
+	}
+}
+
+static void enchant_trie_remove(EnchantTrie* trie,const char *const word)
+{
+	g_return_if_fail(!trie->read_only);
+
+	if (trie->root == ENCHANT_TRIE_NONE)
 		return;
+
+	enchant_trie_remove_from_node(trie, trie->root, word);
+
+	EnchantTrieNode *root = &trie->nodes[trie->root];
+	if (root->edges_size == 0 && root->value == ENCHANT_TRIE_NONE)
+		enchant_trie_clear(trie); /* make trie empty if has no content */
+	else
+		enchant_trie_compact_strings(trie);
+}
+
+static gboolean enchant_trie_contains(const EnchantTrie* trie, const char *word)
+{
+	guint32 node = trie->root;
+	if (node == ENCHANT_TRIE_NONE)
+		return FALSE;
+
+	for (;;) {
+		const EnchantTrieNode *n = &trie->nodes[node];
+		if (n->value != ENCHANT_TRIE_NONE)
+			return strcmp(trie->strings + n->value, word) == 0;
+
+		/* The end of the word is the character 0 */
+		gunichar ch = g_utf8_get_char(word);
+		guint32 edge = enchant_trie_find_edge(trie, node, ch);
+		if (edge == ENCHANT_TRIE_NONE)
+			return FALSE;
+		if (ch == 0)
+			return TRUE;
+		node = trie->edges[edge].node;
+		word = g_utf8_next_char(word);
 	}
+}
 
-	/* If there is a value, just check it, no recursion */
-	if (trie->value != NULL) {
-		gchar* value;
-		int errs = matcher->num_errors;
-		value = trie->value;
-		if(matcher->mode == case_insensitive)
-			{
-				value = g_utf8_strdown(value, -1);
-			}
-		matcher->num_errors = errs + edit_dist(value, 
-					   &(matcher->word[matcher->word_pos]));
-		if(matcher->mode == case_insensitive)
-			{
-				g_free(value);
-			}
+static void enchant_trie_foreach_word_from(EnchantTrie* trie, guint32 node, GString *path,
+					   void (*func)(const char *word, gpointer data), gpointer data)
+{
+	if (node == ENCHANT_TRIE_NONE)
+		return;
 
-		if (matcher->num_errors <= matcher->max_errors) {
-			matcher->cbfunc(g_strconcat(matcher->path,
-							trie->value,NULL),
-					matcher);
+	gsize path_len = path->len;
+	if (node != ENCHANT_TRIE_EOS && trie->nodes[node].value != ENCHANT_TRIE_NONE)
+		g_string_append(path, trie->strings + trie->nodes[node].value);
+	else if (node != ENCHANT_TRIE_EOS) {
+		const EnchantTrieNode *n = &trie->nodes[node];
+		for (guint32 i = 0; i < n->n_edges; i++) {
+			const EnchantTrieEdge *edge = &trie->edges[n->edges + i];
+			if (edge->ch != 0)
+				g_string_append_unichar(path, edge->ch);
+			enchant_trie_foreach_word_from(trie, edge->node, path, func, data);
+			g_string_truncate(path, path_len);
 		}
-		matcher->num_errors = errs;
 		return;
 	}
 
-	ssize_t nxtChI = (ssize_t)(g_utf8_next_char(&matcher->word[matcher->word_pos]) - matcher->word);
-	char *nxtChS = g_strndup(&matcher->word[matcher->word_pos],
-				 (nxtChI - matcher->word_pos));
+	func(path->str, data);
+	g_string_truncate(path, path_len);
+}
+
+/* Call func for every word in the trie, in order */
+static void enchant_trie_foreach_word(EnchantTrie* trie,
+				      void (*func)(const char *word, gpointer data), gpointer data)
+{
+	GString *path = g_string_new(NULL);
+	enchant_trie_foreach_word_from(trie, trie->root, path, func, data);
+	g_string_free(path, TRUE);
+}
+
+static guint32 enchant_trie_edges_hash(const EnchantTrieEdge *edges, guint32 n_edges)
+{
+	guint32 hash = 2166136261u;
+	for (guint32 i = 0; i < n_edges; i++) {
+		hash = (hash ^ edges[i].ch) * 16777619u;
+		hash = (hash ^ edges[i].node) * 16777619u;
+	}
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	return hash;
+}
+
+/* Returns: the slot of the table holding the node with these edges, or
+ * the empty slot where it belongs */
+static guint32 enchant_trie_minimizer_slot(const EnchantTrieMinimizer *minimizer,
+					   const EnchantTrieEdge *edges, guint32 n_edges)
+{
+	const EnchantTrie *trie = minimizer->trie;
+	const guint32 mask = minimizer->table_size - 1;
+	guint32 slot = enchant_trie_edges_hash(edges, n_edges) & mask;
+	for (; minimizer->table[slot] != ENCHANT_TRIE_EOS; slot = (slot + 1) & mask) {
+		const EnchantTrieNode *n = &trie->nodes[minimizer->table[slot]];
+		if (n->n_edges == n_edges &&
+		    memcmp(trie->edges + n->edges, edges, n_edges * sizeof(EnchantTrieEdge)) == 0)
+			break;
+	}
+	return slot;
+}
+
+/* Returns: the node of the trie with these edges, added if there is none */
+static guint32 enchant_trie_minimizer_node(EnchantTrieMinimizer *minimizer,
+					   const EnchantTrieEdge *edges, guint32 n_edges)
+{
+	guint32 slot = enchant_trie_minimizer_slot(minimizer, edges, n_edges);
+	if (minimizer->table[slot] != ENCHANT_TRIE_EOS)
+		return minimizer->table[slot];
+
+	EnchantTrie *trie = minimizer->trie;
+	if (trie->n_edges + n_edges > trie->edges_size) {
+		trie->edges_size = MAX (trie->edges_size * 2, trie->n_edges + n_edges);
+		trie->edges = g_renew(EnchantTrieEdge, trie->edges, trie->edges_size);
+	}
+	memcpy(trie->edges + trie->n_edges, edges, n_edges * sizeof(EnchantTrieEdge));
+
+	guint32 node = enchant_trie_node_new(trie);
+	trie->nodes[node].edges = trie->n_edges;
+	trie->nodes[node].n_edges = trie->nodes[node].edges_size = n_edges;
+	trie->n_edges += n_edges;
+	minimizer->table[slot] = node;
+
+	/* Keep the table at most half full */
+	if (++minimizer->n_table * 2 > minimizer->table_size) {
+		guint32 *old_table = minimizer->table;
+		guint32 old_size = minimizer->table_size;
+		minimizer->table_size *= 2;
+		minimizer->table = g_new0(guint32, minimizer->table_size);
+		for (guint32 i = 0; i < old_size; i++)
+			if (old_table[i] != ENCHANT_TRIE_EOS) {
+				const EnchantTrieNode *n = &trie->nodes[old_table[i]];
+				minimizer->table[enchant_trie_minimizer_slot(minimizer, trie->edges + n->edges,
+									     n->n_edges)] = old_table[i];
+			}
+		g_free(old_table);
+	}
+	return node;
+}
+
+/* Replace the nodes of the path deeper than depth, which are complete, by
+ * nodes of the trie */
+static void enchant_trie_minimizer_complete(EnchantTrieMinimizer *minimizer, guint depth)
+{
+	GArray *path_edges = minimizer->path_edges;
+	GArray *path_starts = minimizer->path_starts;
+	while (path_starts->len > depth + 1) {
+		guint32 start = g_array_index(path_starts, guint32, path_starts->len - 1);
+		guint32 node = enchant_trie_minimizer_node(minimizer,
+							   &g_array_index(path_edges, EnchantTrieEdge, start),
+							   path_edges->len - start);
+		g_array_set_size(path_edges, start);
+		g_array_set_size(path_starts, path_starts->len - 1);
+
+		/* The node is the end of the last edge of its parent */
+		g_array_index(path_edges, EnchantTrieEdge, start - 1).node = node;
+	}
+}
+
+/* Make the empty trie a minimized trie of words, which are sorted, distinct
+ * and normalized */
+static void enchant_trie_build_minimized(EnchantTrie* trie, char **words, guint32 n_words)
+{
+	g_return_if_fail(!trie->read_only && trie->root == ENCHANT_TRIE_NONE);
+
+	EnchantTrieMinimizer minimizer;
+	minimizer.trie = trie;
+	minimizer.table_size = 1024;
+	minimizer.table = g_new0(guint32, minimizer.table_size);
+	minimizer.n_table = 0;
+	minimizer.path_edges = g_array_new(FALSE, FALSE, sizeof(EnchantTrieEdge));
+	minimizer.path_starts = g_array_new(FALSE, FALSE, sizeof(guint32));
+
+	/* The root is on the path of every word */
+	guint32 root_start = 0;
+	g_array_append_val(minimizer.path_starts, root_start);
+
+	const char *last_word = "";
+	for (guint32 i = 0; i < n_words; i++) {
+		const char *word = words[i];
+
+		/* Only the nodes below the prefix shared with the last word are
+		 * complete */
+		size_t shared = 0;
+		while (word[shared] != '\0' && word[shared] == last_word[shared])
+			shared++;
+		while (shared > 0 && (word[shared] & 0xc0) == 0x80)
+			shared--;
+		enchant_trie_minimizer_complete(&minimizer, g_utf8_strlen(word, shared));
+
+		EnchantTrieEdge edge;
+		for (const char *p = word + shared; ; p = g_utf8_next_char(p)) {
+			edge.ch = g_utf8_get_char(p);
+			edge.node = edge.ch == 0 ? ENCHANT_TRIE_EOS : ENCHANT_TRIE_NONE;
+			g_array_append_val(minimizer.path_edges, edge);
+			if (edge.ch == 0)
+				break;
+			guint32 start = minimizer.path_edges->len;
+			g_array_append_val(minimizer.path_starts, start);
+		}
+		last_word = word;
+	}
+	enchant_trie_minimizer_complete(&minimizer, 0);
+
+	if (minimizer.path_edges->len > 0)
+		trie->root = enchant_trie_minimizer_node(&minimizer,
+							 (EnchantTrieEdge *)(void *)minimizer.path_edges->data,
+							 minimizer.path_edges->len);
+
+	g_free(minimizer.table);
+	g_array_free(minimizer.path_edges, TRUE);
+	g_array_free(minimizer.path_starts, TRUE);
+
+	/* Give back the room left for growth */
+	trie->nodes_size = trie->n_nodes;
+	trie->nodes = g_renew(EnchantTrieNode, trie->nodes, trie->nodes_size);
+	trie->edges_size = trie->n_edges;
+	trie->edges = g_renew(EnchantTrieEdge, trie->edges, trie->edges_size);
+	g_free(trie->strings);
+	trie->strings = NULL;
+	trie->strings_size = 0;
+	trie->read_only = TRUE;
+	trie->minimized = TRUE;
+}
 
-	/* Precisely match the first character, and recurse */
-	EnchantTrie* subtrie = enchant_trie_get_subtrie(trie, matcher, &nxtChS);
-	if (subtrie != NULL) {
-		enchant_trie_matcher_pushpath(matcher,nxtChS);
-		ssize_t oldPos = matcher->word_pos;
-		matcher->word_pos = nxtChI;
-		enchant_trie_find_matches(subtrie,matcher);
-		matcher->word_pos = oldPos;
-		enchant_trie_matcher_poppath(matcher,strlen(nxtChS));
+/* Compute the row of the automaton for a path of depth characters, the last
+ * two being prev_ch and ch, from the rows for the two shorter paths (prev2
+ * is unused when depth < 2).  Returns the smallest entry of the row. */
+static int enchant_trie_matcher_step(EnchantTrieMatcher* matcher,
+				     const int* prev2, const int* prev, int* row,
+				     glong depth, gunichar prev_ch, gunichar ch)
+{
+	const int band = matcher->band;
+	const int over = band + 1;
+	const gunichar* word = matcher->word;
+	int row_min = over;
+
+	matcher->visited_nodes++;
+
+	/* Entries further than max_errors from the diagonal can't be within it */
+	const int lo = band - matcher->max_errors, hi = band + matcher->max_errors;
+	for (int d = 0; d < lo; d++)
+		row[d] = row[2 * band - d] = over;
+
+	for (int d = lo; d <= hi; d++) {
+		glong i = depth + d - band;
+		int v;
+		if (i < 0 || i > matcher->word_len)
+			v = over;
+		else if (i == 0)
+			v = MIN (depth, over);
+		else {
+			int cost = word[i - 1] != ch;
+			v = prev[d] + cost;
+			if (d < hi)
+				v = MIN (v, prev[d + 1] + 1);
+			if (d > lo)
+				v = MIN (v, row[d - 1] + 1);
+			if (i > 1 && depth > 1 && ch == word[i - 2] && prev_ch == word[i - 1])
+				v = MIN (v, prev2[d] + cost);
+			v = MIN (v, over);
+		}
+		row[d] = v;
+		row_min = MIN (row_min, v);
 	}
 
-	g_free(nxtChS);
+	return row_min;
+}
+
+/* Report the path, followed by value if given, if the whole word is within
+ * max_errors of it */
+static void enchant_trie_matcher_report(EnchantTrieMatcher* matcher, const int* row,
+					glong depth, const char* value)
+{
+	glong d = matcher->word_len - depth + matcher->band;
+	if (d < 0 || d > 2 * matcher->band || row[d] > matcher->max_errors)
+		return;
+
+	matcher->num_errors = row[d];
+	matcher->cbfunc(value ? g_strconcat(matcher->path, value, NULL) : g_strdup(matcher->path),
+			matcher);
+}
 
-	matcher->num_errors++;
-	if (matcher->word[matcher->word_pos] != '\0') {
-		/* Match on inserting word[0] */
-		ssize_t oldPos = matcher->word_pos;
-		matcher->word_pos = nxtChI;
-		enchant_trie_find_matches(trie,matcher);
-		matcher->word_pos = oldPos;
+/* Run the automaton over the string stored in a leaf, whose path is depth
+ * characters long */
+static void enchant_trie_matcher_match_value(EnchantTrieMatcher* matcher, const char* value,
+					     const int* prev2, const int* prev,
+					     glong depth, gunichar prev_ch)
+{
+	int rows[3][2 * ENCHANT_PWL_MAX_ERRORS + 1];
+	int n_rows = 0;
+
+	for (const char* p = value; *p; p = g_utf8_next_char(p)) {
+		gunichar ch = g_utf8_get_char(p);
+		int* row = rows[n_rows++ % 3];
+		depth++;
+		if (enchant_trie_matcher_step(matcher, prev2, prev, row, depth, prev_ch, ch) > matcher->max_errors)
+			return;
+		prev2 = prev;
+		prev = row;
+		prev_ch = ch;
 	}
-	/* for each subtrie, match on delete or substitute word[0] or transpose word[0] and word[1] */
-	g_hash_table_foreach(trie->subtries,
-				enchant_trie_find_matches_cb,
-				matcher);
-	matcher->num_errors--;
+
+	enchant_trie_matcher_report(matcher, prev, depth, value);
+}
+
+/* Set up a frame for node, whose path is depth characters long.  Edges are
+ * followed in order, except that the one that continues the closest
+ * alignment with the word goes first: finding good matches early lowers
+ * max_errors for the rest of the search. */
+static void enchant_trie_matcher_push_frame(const EnchantTrie* trie, const EnchantTrieMatcher* matcher,
+					    EnchantTrieFrame* frame, guint32 node, const int* row,
+					    glong depth, gunichar ch, int row_min)
+{
+	frame->node = node;
+	frame->next_edge = 0;
+	frame->first_edge = ENCHANT_TRIE_NONE;
+	frame->ch = ch;
+	frame->row_min = row_min;
+	frame->path_pos = matcher->path_pos;
+
+	int d = 0;
+	while (row[d] != row_min)
+		d++;
+	glong i = depth + d - matcher->band;
+	if (i >= matcher->word_len)
+		return;
+
+	guint32 edge = enchant_trie_find_edge(trie, node, matcher->word[i]);
+	if (edge != ENCHANT_TRIE_NONE)
+		frame->first_edge = edge - trie->nodes[node].edges;
 }
 
-static void enchant_trie_find_matches_cb(void* keyV,void* subtrieV,void* matcherV)
+static void enchant_trie_find_matches(EnchantTrie* trie,EnchantTrieMatcher *matcher)
 {
-	char *key = (char*) keyV;
-	EnchantTrie *subtrie = (EnchantTrie*) subtrieV;
-	EnchantTrieMatcher *matcher = (EnchantTrieMatcher*) matcherV;
+	g_return_if_fail(matcher);
+
+	/* Can't match in the empty trie */
+	if(trie->root == ENCHANT_TRIE_NONE) {
+		return;
+	}
+
+	const int width = 2 * matcher->band + 1;
+	const int over = matcher->band + 1;
+	matcher->path_pos = 0;
+	matcher->path[0] = '\0';
 
-	ssize_t nxtChI = (ssize_t) (g_utf8_next_char(&matcher->word[matcher->word_pos]) - matcher->word);
+	guint32 stack_size = 16;
+	EnchantTrieFrame *stack = g_new(EnchantTrieFrame, stack_size);
+	int *rows = g_new(int, stack_size * width);
 
-	/* Dont handle actual matches, that's already done */
-	if (strncmp(key,&matcher->word[matcher->word_pos],nxtChI-matcher->word_pos) == 0) {
+	/* The empty path is as far from each prefix of the word as it is long */
+	int row_min = over;
+	for (int d = 0; d < width; d++) {
+		glong i = d - matcher->band;
+		rows[d] = (i < 0 || i > matcher->word_len) ? over : MIN (i, over);
+		row_min = MIN (row_min, rows[d]);
+	}
+
+	const EnchantTrieNode *root = &trie->nodes[trie->root];
+	if (root->value != ENCHANT_TRIE_NONE) {
+		enchant_trie_matcher_match_value(matcher, trie->strings + root->value, NULL, rows, 0, 0);
+		g_free(rows);
+		g_free(stack);
 		return;
 	}
 
-	enchant_trie_matcher_pushpath(matcher,key);
+	guint32 depth = 0;
+	enchant_trie_matcher_push_frame(trie, matcher, &stack[0], trie->root, rows, 0, 0, row_min);
 
-	/* Match on deleting word[0] */
-	enchant_trie_find_matches(subtrie,matcher);
-	/* Match on substituting word[0] */
-	ssize_t oldPos = matcher->word_pos;
-	matcher->word_pos = nxtChI;
-	enchant_trie_find_matches(subtrie,matcher);
+	for (;;) {
+		EnchantTrieFrame *frame = &stack[depth];
+		const EnchantTrieNode *n = &trie->nodes[frame->node];
 
-	enchant_trie_matcher_poppath(matcher,strlen(key));
+		/* Done with this level, or it can no longer lead anywhere since
+		 * max_errors went down */
+		if (frame->next_edge >= n->n_edges || frame->row_min > matcher->max_errors) {
+			if (depth == 0)
+				break;
+			depth--;
+			continue;
+		}
 
-	/* Match on transposing word[0] and word[1] */
-	char *key2 = g_strndup(&matcher->word[oldPos],nxtChI-oldPos);
-	EnchantTrie *subtrie2 = enchant_trie_get_subtrie(subtrie, matcher, &key2);
+		guint32 e = frame->next_edge++;
+		if (frame->first_edge != ENCHANT_TRIE_NONE)
+			e = e == 0 ? frame->first_edge : e - (e <= frame->first_edge);
+		const EnchantTrieEdge *edge = &trie->edges[n->edges + e];
+		int *row = rows + depth * width;
+		matcher->path_pos = frame->path_pos;
+		matcher->path[matcher->path_pos] = '\0';
+
+		/* The path is a complete word */
+		if (edge->node == ENCHANT_TRIE_EOS) {
+			enchant_trie_matcher_report(matcher, row, depth, NULL);
+			continue;
+		}
 
-	if(subtrie2 != NULL) {
-		nxtChI = (ssize_t) (g_utf8_next_char(&matcher->word[matcher->word_pos]) - matcher->word);
-		if (strncmp(key,&matcher->word[matcher->word_pos],nxtChI-matcher->word_pos) == 0) {
-			matcher->word_pos = nxtChI;
-			enchant_trie_matcher_pushpath(matcher,key);
-			enchant_trie_matcher_pushpath(matcher,key2);
+		if (depth + 1 == stack_size) {
+			stack_size *= 2;
+			stack = g_renew(EnchantTrieFrame, stack, stack_size);
+			rows = g_renew(int, rows, stack_size * width);
+			frame = &stack[depth];
+			row = rows + depth * width;
+		}
 
-			enchant_trie_find_matches(subtrie2,matcher);
-			enchant_trie_matcher_poppath(matcher,strlen(key2));
-			enchant_trie_matcher_poppath(matcher,strlen(key));
+		gunichar ch = edge->ch;
+		int *next_row = row + width;
+		row_min = enchant_trie_matcher_step(matcher, depth > 0 ? row - width : NULL, row, next_row,
+						    depth + 1, frame->ch, ch);
+		if (row_min > matcher->max_errors)
+			continue;
+
+		enchant_trie_matcher_pushchar(matcher, edge->ch);
+		const EnchantTrieNode *child = &trie->nodes[edge->node];
+		if (child->value != ENCHANT_TRIE_NONE) {
+			enchant_trie_matcher_match_value(matcher, trie->strings + child->value,
+							 row, next_row, depth + 1, ch);
+			continue;
 		}
+
+		depth++;
+		enchant_trie_matcher_push_frame(trie, matcher, &stack[depth], edge->node, next_row,
+						depth, ch, row_min);
 	}
 
-	g_free(key2);
-	
-	matcher->word_pos = oldPos;
+	g_free(rows);
+	g_free(stack);
 }
 
 static EnchantTrieMatcher* enchant_trie_matcher_init(const char* const word,
@@ -954,20 +3704,21 @@ static EnchantTrieMatcher* enchant_trie_matcher_init(const char* const word,
 	char * normalized_word = g_utf8_normalize (word, len, G_NORMALIZE_NFD);
 	len = strlen(normalized_word);
 
+	/* folded as the words of the folded trie are, whatever the locale */
 	char * pattern = normalized_word;
 	if (mode == case_insensitive)
 		{
-			pattern = g_utf8_strdown (normalized_word, len);
+			pattern = enchant_utf8_fold (normalized_word);
 			g_free(normalized_word);
 		}
 
 	EnchantTrieMatcher* matcher = g_new(EnchantTrieMatcher,1);
 	matcher->num_errors = 0;
 	matcher->max_errors = maxerrs;
-	matcher->word = g_new0(char,len+maxerrs+2); // Ensure matcher does not overrun buffer: +2 for transpose check
-	strcpy(matcher->word, pattern);
+	matcher->band = maxerrs;
+	matcher->visited_nodes = 0;
+	matcher->word = g_utf8_to_ucs4_fast(pattern, -1, &matcher->word_len);
 	g_free(pattern);
-	matcher->word_pos = 0;
 	matcher->path = g_new0(char,len+maxerrs+1);
 	matcher->path[0] = '\0';
 	matcher->path_len = len+maxerrs+1;
@@ -986,9 +3737,8 @@ static void enchant_trie_matcher_free(EnchantTrieMatcher* matcher)
 	g_free(matcher);
 }
 
-static void enchant_trie_matcher_pushpath(EnchantTrieMatcher* matcher,char* newchars)
+static void enchant_trie_matcher_pushpath(EnchantTrieMatcher* matcher,const char* newchars,ssize_t len)
 {
-	ssize_t len = strlen(newchars);
 	if(matcher->path_pos + len >= matcher->path_len) {
 		matcher->path_len = matcher->path_len + len + 10;
 		matcher->path = g_renew(char,matcher->path,matcher->path_len);
@@ -1001,48 +3751,195 @@ static void enchant_trie_matcher_pushpath(EnchantTrieMatcher* matcher,char* newc
 	matcher->path[matcher->path_pos] = '\0';
 }
 
-static void enchant_trie_matcher_poppath(EnchantTrieMatcher* matcher,int num)
+/* Push the character ch onto the path, returning the number of bytes pushed */
+static int enchant_trie_matcher_pushchar(EnchantTrieMatcher* matcher,gunichar ch)
+{
+	char newchars[6];
+	int len = ch ? g_unichar_to_utf8(ch, newchars) : 0;
+	enchant_trie_matcher_pushpath(matcher, newchars, len);
+	return len;
+}
+
+/* Decode at most max characters of a UTF-8 string into buf, returning the
+ * length of the whole string in characters */
+static glong edit_dist_decode(const char* word, gunichar* buf, glong max)
 {
-	g_return_if_fail(matcher->path_pos >= 0);
-	matcher->path_pos = matcher->path_pos - num;
-	if(matcher->path_pos < 0) {
-		matcher->path_pos = 0;
+	glong len = 0;
+	for (const char* p = word; *p; len++) {
+		gunichar ch = (guchar)*p;
+		if (ch < 0x80)
+			p++;
+		else {
+			ch = g_utf8_get_char(p);
+			p = g_utf8_next_char(p);
+		}
+		if (len < max)
+			buf[len] = ch;
 	}
-	matcher->path[matcher->path_pos] = '\0';
+	return len;
 }
 
-static int edit_dist(const char* utf8word1, const char* utf8word2)
+/* Optimal string alignment distance (Levenshtein plus transposition of two
+ * adjacent characters) for a pattern of at most EDIT_DIST_MAX_PATTERN
+ * characters, using Hyyrö's bit-vector formulation of Myers' algorithm: one
+ * column of the table is kept as bit masks of vertical deltas, so each
+ * character of text costs a handful of word operations.
+ */
+static int edit_dist_bit_parallel(const gunichar* pattern, glong pattern_len,
+				  const gunichar* text, glong text_len, int max_dist)
 {
-	glong len1, len2;
-	gunichar * word1 = g_utf8_to_ucs4_fast(utf8word1, -1, &len1);
-	gunichar * word2 = g_utf8_to_ucs4_fast(utf8word2, -1, &len2);
+	gunichar chars[EDIT_DIST_MAX_PATTERN];
+	guint64 masks[EDIT_DIST_MAX_PATTERN];
+	int n_chars = 0;
+
+	/* Bit i of the mask for a character is set where pattern[i] is that character */
+	for (glong i = 0; i < pattern_len; i++) {
+		int k = 0;
+		while (k < n_chars && chars[k] != pattern[i])
+			k++;
+		if (k == n_chars) {
+			chars[n_chars] = pattern[i];
+			masks[n_chars++] = 0;
+		}
+		masks[k] |= G_GUINT64_CONSTANT(1) << i;
+	}
 
-	int * table = g_new0(int, (len1+1)*(len2+1));
-	
-	/* Initialise outer rows of table */
-	for (glong i = 0; i < len1 + 1; i++)
-		table[i*(len2+1)] = i;
-	for (glong i = 0; i < len2 + 1; i++)
-		table[i] = i;
-
-	/* Fill in table in dynamic programming style */
-	for (glong i = 1; i < len1+1; i++){
-		for (glong j = 1; j < len2+1; j++) {
-			int cost = word1[i-1] != word2[j-1];
-			int v1 = table[(i-1)*(len2+1)+j] + 1;
-			if (i > 1 && j > 1 && word1[i-1] == word2[j-2] && word1[i-2] == word2[j-1]) {
-				v1 = MIN (v1, table[(i-2)*(len2+1)+(j-2)] + cost);
+	const guint64 last = G_GUINT64_CONSTANT(1) << (pattern_len - 1);
+	guint64 vp = ~G_GUINT64_CONSTANT(0), vn = 0, d0 = 0, pm_prev = 0;
+	int dist = pattern_len;
+
+	for (glong j = 0; j < text_len; j++) {
+		guint64 pm = 0;
+		for (int k = 0; k < n_chars; k++)
+			if (chars[k] == text[j]) {
+				pm = masks[k];
+				break;
 			}
 
-			int v2 = table[i*(len2+1)+(j-1)] + 1;
-			int v3 = table[(i-1)*(len2+1)+(j-1)] + cost;
-			table[i*(len2+1)+j] = MIN (MIN (v1, v2), v3);
+		guint64 tr = (((~d0) & pm) << 1) & pm_prev;
+		d0 = (((pm & vp) + vp) ^ vp) | pm | vn | tr;
+		guint64 hp = vn | ~(d0 | vp);
+		guint64 hn = d0 & vp;
+		if (hp & last)
+			dist++;
+		else if (hn & last)
+			dist--;
+
+		/* Each remaining character can lower the distance by at most one */
+		if (dist - (text_len - j - 1) > max_dist)
+			return max_dist + 1;
+
+		hp = (hp << 1) | 1;
+		hn = hn << 1;
+		vp = hn | ~(d0 | hp);
+		vn = hp & d0;
+		pm_prev = pm;
+	}
+
+	return MIN (dist, max_dist + 1);
+}
+
+/* The same distance for longer words, filling in only the diagonal band of
+ * the table that can hold values up to max_dist.  Rows are kept in fixed
+ * buffers indexed by j - i + max_dist, and word2 is decoded into a ring that
+ * holds the window of characters the band can look at.
+ */
+static int edit_dist_banded(const char* word1, glong len1,
+			    const char* word2, glong len2, int max_dist)
+{
+	int rows[3][2 * EDIT_DIST_MAX_BAND + 1];
+	gunichar ring[EDIT_DIST_RING_SIZE];
+	const int width = 2 * max_dist + 1;
+	const int over = max_dist + 1;
+
+	int *prev2 = rows[0], *prev = rows[1], *cur = rows[2];
+	for (int d = 0; d < width; d++) {
+		glong j = d - max_dist;
+		prev[d] = (j < 0 || j > len2) ? over : MIN (j, over);
+		prev2[d] = over;
+	}
+
+	const char* p1 = word1;
+	const char* p2 = word2;
+	glong decoded = 0;
+	gunichar c1 = 0;
+	for (glong i = 1; i <= len1; i++) {
+		gunichar c1_prev = c1;
+		c1 = g_utf8_get_char(p1);
+		p1 = g_utf8_next_char(p1);
+		for (; decoded < MIN (i + max_dist, len2); decoded++) {
+			ring[decoded % EDIT_DIST_RING_SIZE] = g_utf8_get_char(p2);
+			p2 = g_utf8_next_char(p2);
+		}
+
+		int row_min = over;
+		for (int d = 0; d < width; d++) {
+			glong j = i + d - max_dist;
+			int v;
+			if (j < 0 || j > len2)
+				v = over;
+			else if (j == 0)
+				v = MIN (i, over);
+			else {
+				gunichar c2 = ring[(j - 1) % EDIT_DIST_RING_SIZE];
+				int cost = c1 != c2;
+				v = prev[d] + cost;
+				if (d + 1 < width)
+					v = MIN (v, prev[d + 1] + 1);
+				if (d > 0)
+					v = MIN (v, cur[d - 1] + 1);
+				if (i > 1 && j > 1 && c1 == ring[(j - 2) % EDIT_DIST_RING_SIZE] && c1_prev == c2)
+					v = MIN (v, prev2[d] + cost);
+				v = MIN (v, over);
+			}
+			cur[d] = v;
+			row_min = MIN (row_min, v);
 		}
+
+		/* Every alignment passes through this row */
+		if (row_min > max_dist)
+			return over;
+
+		int *tmp = prev2;
+		prev2 = prev;
+		prev = cur;
+		cur = tmp;
+	}
+
+	return prev[len2 - len1 + max_dist];
+}
+
+/* Damerau-Levenshtein (optimal string alignment) distance between two
+ * UTF-8 strings, computed only as far as needed to tell whether it is within
+ * max_dist.  Returns the distance, or max_dist + 1 if it is larger.  Nothing
+ * is allocated.
+ */
+static int edit_dist(const char* utf8word1, const char* utf8word2, int max_dist)
+{
+	g_return_val_if_fail(max_dist >= 0 && max_dist <= EDIT_DIST_MAX_BAND, max_dist + 1);
+
+	/* Words short enough for the bit-parallel kernel are decoded whole */
+	gunichar word1[EDIT_DIST_MAX_PATTERN + EDIT_DIST_MAX_BAND];
+	gunichar word2[EDIT_DIST_MAX_PATTERN + EDIT_DIST_MAX_BAND];
+	glong len1 = edit_dist_decode(utf8word1, word1, G_N_ELEMENTS(word1));
+	glong len2 = edit_dist_decode(utf8word2, word2, G_N_ELEMENTS(word2));
+
+	/* The distance is symmetric, so let word1 be the shorter */
+	if (len1 > len2) {
+		if (len1 - len2 > max_dist)
+			return max_dist + 1;
+		if (len2 == 0)
+			return len1;
+		if (len2 <= EDIT_DIST_MAX_PATTERN)
+			return edit_dist_bit_parallel(word2, len2, word1, len1, max_dist);
+		return edit_dist_banded(utf8word2, len2, utf8word1, len1, max_dist);
 	}
 
-	int cost = table[len1*(len2+1) + len2];
-	g_free(word1);
-	g_free(word2);
-	g_free(table);
-	return cost;
+	if (len2 - len1 > max_dist)
+		return max_dist + 1;
+	if (len1 == 0)
+		return len2;
+	if (len1 <= EDIT_DIST_MAX_PATTERN)
+		return edit_dist_bit_parallel(word1, len1, word2, len2, max_dist);
+	return edit_dist_banded(utf8word1, len1, utf8word2, len2, max_dist);
 }
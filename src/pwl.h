@@ -38,17 +38,60 @@ extern "C" {
 
 typedef struct str_enchant_pwl EnchantPWL;
 
+/*how suggestions are searched for*/
+typedef enum {
+	ENCHANT_PWL_SUGGEST_INDEX_AUTO,   /*the deletion index, once the list is large*/
+	ENCHANT_PWL_SUGGEST_INDEX_NEVER,  /*the trie*/
+	ENCHANT_PWL_SUGGEST_INDEX_ALWAYS  /*the deletion index*/
+} EnchantPWLSuggestIndex;
+
 /* Create and initialise a new, empty PWL */
 EnchantPWL* enchant_pwl_init(void);
 EnchantPWL* enchant_pwl_init_with_file(const char * file);
+/* Open a word list which is never written to, keeping it as a minimal automaton */
+EnchantPWL* enchant_pwl_init_with_file_read_only(const char * file);
+/* Open the PWL of a file shared by all its users in the process, counting references */
+EnchantPWL* enchant_pwl_init_with_file_shared(const char * file);
 
 void enchant_pwl_add(EnchantPWL * me, const char *const word, size_t len);
 void enchant_pwl_remove(EnchantPWL * me, const char *const word, size_t len);
+/*add or remove several words, writing them to the file at once; if generation is
+  not NULL and was the generation of the words before, it becomes the generation
+  after the change, else 0 when the words also changed otherwise*/
+void enchant_pwl_add_many(EnchantPWL * me, const char *const *words,
+			  const size_t *lens, size_t n_words, uint64_t *generation);
+void enchant_pwl_remove_many(EnchantPWL * me, const char *const *words,
+			     const size_t *lens, size_t n_words, uint64_t *generation);
 int enchant_pwl_check(EnchantPWL * me,const char *const word, size_t len);
+/*look a word up in a PWL and in the PWL of the words excluded from it, if any, normalizing it once;
+  returns 1 if it is excluded, 0 if it is in the PWL and -1 otherwise*/
+int enchant_pwl_check_with_exclude(EnchantPWL * me, EnchantPWL * exclude,
+				   const char *const word, size_t len);
 /*gives the best set of suggestions from pwl that are at least as good as the given suggs*/
 char** enchant_pwl_suggest(EnchantPWL *me, const char *const word,
 			   size_t len, char ** suggs, size_t* out_n_suggs);
+/*as enchant_pwl_suggest, given suggs which are NFD-normalized already*/
+char** enchant_pwl_suggest_normalized(EnchantPWL *me, const char *const word,
+				      size_t len, char ** normalized_suggs, size_t* out_n_suggs);
+/*number of trie nodes or indexed words looked at by enchant_pwl_suggest so far, to measure its work*/
+size_t enchant_pwl_get_visited_nodes(EnchantPWL * me);
+/*lookups of words in the PWL, those of them its membership filter ruled out,
+  and those it let through for words not in the PWL*/
+void enchant_pwl_get_filter_stats(EnchantPWL * me, size_t *n_lookups, size_t *n_rejected,
+				  size_t *n_false_positives);
+/*a number which changes whenever the words of the PWL do, after looking for changes
+  to the file as the refresh policy says; never 0*/
+uint64_t enchant_pwl_get_generation(EnchantPWL * me);
+/*free a PWL, or drop a reference to a shared PWL*/
 void enchant_pwl_free(EnchantPWL* me);
+/*whether to keep a compiled index of the words next to the file, mapped in
+  place of parsing the file; off unless the file is one of enchant's own*/
+void enchant_pwl_set_compiled_index(EnchantPWL * me, int enabled);
+/*whether to answer suggestions from a deletion index rather than the trie*/
+void enchant_pwl_set_suggest_index(EnchantPWL * me, EnchantPWLSuggestIndex mode);
+/*how often to look for changes made to the file by other processes*/
+void enchant_pwl_set_refresh_policy(EnchantPWL * me, EnchantPWLRefreshPolicy policy,
+				    unsigned int interval_ms);
 
 #ifdef __cplusplus
 }
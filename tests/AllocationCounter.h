@@ -0,0 +1,44 @@
+/* Copyright (c) 2026 Enchant contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __ALLOCATIONCOUNTER
+#define __ALLOCATIONCOUNTER
+
+#include <stdlib.h>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define ENCHANT_TEST_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define ENCHANT_TEST_ASAN 1
+#endif
+#endif
+
+#if defined(__GLIBC__) && !defined(ENCHANT_TEST_ASAN)
+// Count the allocations made while countAllocations is set, by standing in
+// for the allocator of the C library in AllocationCounter.cpp
+#define ENCHANT_TEST_COUNT_ALLOCATIONS 1
+
+extern bool countAllocations;
+extern int nAllocations;
+#endif
+
+#endif
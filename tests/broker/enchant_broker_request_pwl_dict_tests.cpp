@@ -79,6 +79,67 @@ TEST_FIXTURE(EnchantBrokerRequestPwlDictionary_TestFixture,
     CHECK_EQUAL(_dict, dict);
 }
 
+TEST_FIXTURE(EnchantBrokerRequestPwlDictionary_TestFixture, 
+             EnchantBrokerRequestPwlDictionary_OtherBroker_SharesWords)
+{
+    EnchantBroker* broker = enchant_broker_init();
+    // neither looks at the file again, so they only agree if they share the list
+    enchant_broker_set_pwl_refresh_policy(_broker, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+    enchant_broker_set_pwl_refresh_policy(broker, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+
+    _dict = enchant_broker_request_pwl_dict(_broker, _pwlFile.c_str());
+    EnchantDict* dict = enchant_broker_request_pwl_dict(broker, _pwlFile.c_str());
+    CHECK(dict != _dict);
+
+    enchant_dict_add(_dict, "hello", -1);
+    CHECK_EQUAL(0, enchant_dict_check(dict, "hello", -1));
+
+    enchant_dict_remove(dict, "hello", -1);
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "hello", -1));
+
+    enchant_broker_free_dict(broker, dict);
+    enchant_broker_free(broker);
+}
+
+TEST_FIXTURE(EnchantBrokerRequestPwlDictionary_TestFixture, 
+             EnchantBrokerRequestPwlDictionary_OtherPathToSameFile_SharesWords)
+{
+    EnchantBroker* broker = enchant_broker_init();
+    enchant_broker_set_pwl_refresh_policy(_broker, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+    enchant_broker_set_pwl_refresh_policy(broker, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+
+    _dict = enchant_broker_request_pwl_dict(_broker, _pwlFile.c_str());
+    char* dirname = g_path_get_dirname(_pwlFile.c_str());
+    char* basename = g_path_get_basename(_pwlFile.c_str());
+    char* otherPath = g_build_filename(dirname, ".", basename, NULL);
+    EnchantDict* dict = enchant_broker_request_pwl_dict(broker, otherPath);
+
+    enchant_dict_add(_dict, "hello", -1);
+    CHECK_EQUAL(0, enchant_dict_check(dict, "hello", -1));
+
+    enchant_broker_free_dict(broker, dict);
+    enchant_broker_free(broker);
+    g_free(otherPath);
+    g_free(basename);
+    g_free(dirname);
+}
+
+TEST_FIXTURE(EnchantBrokerRequestPwlDictionary_TestFixture, 
+             EnchantBrokerRequestPwlDictionary_OtherBrokerFreed_WordsKept)
+{
+    EnchantBroker* broker = enchant_broker_init();
+    EnchantDict* dict = enchant_broker_request_pwl_dict(broker, _pwlFile.c_str());
+    enchant_dict_add(dict, "hello", -1);
+
+    _dict = enchant_broker_request_pwl_dict(_broker, _pwlFile.c_str());
+    enchant_broker_free_dict(broker, dict);
+    enchant_broker_free(broker);
+
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    enchant_dict_add(_dict, "world", -1);
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "world", -1));
+}
+
 TEST_FIXTURE(EnchantBrokerRequestPwlDictionary_TestFixture, 
              EnchantBrokerRequestPwlDictionary_HasPreviousError_ErrorCleared)
 {
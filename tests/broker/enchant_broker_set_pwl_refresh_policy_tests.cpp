@@ -0,0 +1,156 @@
+/* Copyright (c) 2026 Enchant contributors
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include <enchant.h>
+
+#include "EnchantDictionaryTestFixture.h"
+
+struct EnchantBrokerSetPwlRefreshPolicy_TestFixture : EnchantDictionaryTestFixture
+{
+    //Setup
+    EnchantBrokerSetPwlRefreshPolicy_TestFixture():
+        EnchantDictionaryTestFixture(EmptyDictionary_ProviderConfiguration)
+    { }
+
+    //Wait for the watcher to notice a change made by another process
+    bool IsWordInDictionaryEventually(const std::string& word)
+    {
+        for(int i = 0; i < 100; ++i)
+        {
+            if(IsWordInDictionary(word))
+                return true;
+            g_usleep(20000);
+        }
+        return false;
+    }
+};
+
+/**
+ * enchant_broker_set_pwl_refresh_policy
+ * @broker: A non-null #EnchantBroker
+ * @policy: An #EnchantPWLRefreshPolicy
+ * @interval_ms: The time between looking for changes in milliseconds, for
+ * %ENCHANT_PWL_REFRESH_THROTTLED
+ *
+ * Declares how the personal word lists and exclude lists of the dictionaries
+ * of @broker, already requested or requested later, look for changes made to
+ * their files by other processes.
+ */
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Normal Operation
+TEST_FIXTURE(EnchantBrokerSetPwlRefreshPolicy_TestFixture,
+             EnchantBrokerSetPwlRefreshPolicy_Throttled_ExternalChangeSeenLater)
+{
+    CHECK(!IsWordInDictionary("hello"));
+    enchant_broker_set_pwl_refresh_policy(_broker, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+    CHECK(!IsWordInDictionary("hello"));
+
+    ExternalAddWordToDictionary("hello");
+    CHECK(!IsWordInDictionary("hello"));
+
+    enchant_broker_set_pwl_refresh_policy(_broker, ENCHANT_PWL_REFRESH_ALWAYS, 0);
+    CHECK(IsWordInDictionary("hello"));
+}
+
+TEST_FIXTURE(EnchantBrokerSetPwlRefreshPolicy_TestFixture,
+             EnchantBrokerSetPwlRefreshPolicy_Throttled_OwnChangeSeenImmediately)
+{
+    enchant_broker_set_pwl_refresh_policy(_broker, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+    CHECK(!IsWordInDictionary("hello"));
+
+    AddWordToDictionary("hello");
+    CHECK(IsWordInDictionary("hello"));
+
+    RemoveWordFromDictionary("hello");
+    CHECK(!IsWordInDictionary("hello"));
+}
+
+TEST_FIXTURE(EnchantBrokerSetPwlRefreshPolicy_TestFixture,
+             EnchantBrokerSetPwlRefreshPolicy_AppliesToDictionariesRequestedLater)
+{
+    enchant_broker_set_pwl_refresh_policy(_broker, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+    ReloadTestDictionary();
+    CHECK(!IsWordInDictionary("hello"));
+
+    ExternalAddWordToDictionary("hello");
+    CHECK(!IsWordInDictionary("hello"));
+}
+
+TEST_FIXTURE(EnchantBrokerSetPwlRefreshPolicy_TestFixture,
+             EnchantBrokerSetPwlRefreshPolicy_OtherBrokerWithoutPolicy_PolicyKept)
+{
+    enchant_broker_set_pwl_refresh_policy(_broker, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+    CHECK(!IsWordInDictionary("hello"));
+
+    // shares the lists, but declares no policy for them
+    EnchantBroker* broker = enchant_broker_init();
+    EnchantDict* dict = enchant_broker_request_dict(broker, languageTag.c_str());
+    CHECK(dict);
+
+    ExternalAddWordToDictionary("hello");
+    CHECK(!IsWordInDictionary("hello"));
+
+    if(dict)
+        enchant_broker_free_dict(broker, dict);
+    enchant_broker_free(broker);
+}
+
+TEST_FIXTURE(EnchantBrokerSetPwlRefreshPolicy_TestFixture,
+             EnchantBrokerSetPwlRefreshPolicy_Throttled_ChangeBeforeFirstUseSeen)
+{
+    enchant_broker_set_pwl_refresh_policy(_broker, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+    ReloadTestDictionary();
+
+    // the lists are only read when first used
+    ExternalAddWordToDictionary("hello");
+    CHECK(IsWordInDictionary("hello"));
+
+    ExternalAddWordToDictionary("world");
+    CHECK(!IsWordInDictionary("world"));
+}
+
+TEST_FIXTURE(EnchantBrokerSetPwlRefreshPolicy_TestFixture,
+             EnchantBrokerSetPwlRefreshPolicy_Notify_ExternalChangeSeen)
+{
+    enchant_broker_set_pwl_refresh_policy(_broker, ENCHANT_PWL_REFRESH_NOTIFY, 3600 * 1000);
+    CHECK(!IsWordInDictionary("hello"));
+
+    ExternalAddWordToDictionary("hello");
+    CHECK(IsWordInDictionaryEventually("hello"));
+
+    ExternalAddWordToExclude("hello");
+    for(int i = 0; i < 100 && IsWordInDictionary("hello"); ++i)
+        g_usleep(20000);
+    CHECK(!IsWordInDictionary("hello"));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Error Conditions
+TEST_FIXTURE(EnchantBrokerSetPwlRefreshPolicy_TestFixture,
+             EnchantBrokerSetPwlRefreshPolicy_NullBroker_DoNothing)
+{
+    enchant_broker_set_pwl_refresh_policy(NULL, ENCHANT_PWL_REFRESH_THROTTLED, 3600 * 1000);
+
+    ExternalAddWordToDictionary("hello");
+    CHECK(IsWordInDictionary("hello"));
+}
@@ -0,0 +1,203 @@
+/* Copyright (c) 2026 Enchant contributors
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include <enchant.h>
+#include <fstream>
+
+#include "EnchantDictionaryTestFixture.h"
+
+static std::vector<std::string> wordsAdded;
+
+static void
+MockDictionaryAddToPersonal (EnchantDict *, const char *const word, size_t len)
+{
+    wordsAdded.push_back(std::string(word, len));
+}
+
+static EnchantDict* MockProviderRequestAddToPersonalMockDictionary(EnchantProvider * me, const char *tag)
+{
+    EnchantDict* dict = MockProviderRequestEmptyMockDictionary(me, tag);
+    dict->add_to_personal = MockDictionaryAddToPersonal;
+    return dict;
+}
+
+static void DictionaryAddToPersonal_ProviderConfiguration (EnchantProvider * me, const char *)
+{
+     me->request_dict = MockProviderRequestAddToPersonalMockDictionary;
+     me->dispose_dict = MockProviderDisposeDictionary;
+}
+
+struct EnchantDictionaryAddMany_TestFixture : EnchantDictionaryTestFixture
+{
+    //Setup
+    EnchantDictionaryAddMany_TestFixture():
+            EnchantDictionaryTestFixture(DictionaryAddToPersonal_ProviderConfiguration)
+    { 
+        wordsAdded.clear();
+    }
+
+    size_t CountLines(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str());
+        std::string line;
+        size_t n_lines = 0;
+        while(std::getline(file, line))
+            ++n_lines;
+        return n_lines;
+    }
+};
+
+/**
+ * enchant_dict_add_many
+ * @dict: A non-null #EnchantDict
+ * @words: The words you wish to add to your personal dictionary, in UTF-8 encoding
+ * @lens: The byte lengths of @words, each -1 for strlen, or NULL for all strlen
+ * @n_words: The number of @words
+ */
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Normal Operation
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_WordsExistInDictionary)
+{
+    const char* words[] = { "hello", "world" };
+    enchant_dict_add_many(_dict, words, NULL, 2);
+    CHECK(IsWordInDictionary("hello"));
+    CHECK(IsWordInDictionary("world"));
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_WordsExistInSession)
+{
+    const char* words[] = { "hello", "world" };
+    enchant_dict_add_many(_dict, words, NULL, 2);
+    CHECK(IsWordInSession("hello"));
+    CHECK(IsWordInSession("world"));
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_OneLinePerWordInEnchantPwlFile)
+{
+    const char* words[] = { "hello", "world", "hello" };
+    enchant_dict_add_many(_dict, words, NULL, 3);
+    CHECK_EQUAL(2u, CountLines(GetPersonalDictFileName()));
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_PassedOnToProvider_LensSpecified)
+{
+    const char* words[] = { "hellodisregard me", "world" };
+    ssize_t lens[] = { 5, -1 };
+    enchant_dict_add_many(_dict, words, lens, 2);
+    CHECK_EQUAL(2u, wordsAdded.size());
+    CHECK_EQUAL(std::string("hello"), wordsAdded[0]);
+    CHECK_EQUAL(std::string("world"), wordsAdded[1]);
+    CHECK(!IsWordInDictionary("hellodisregard me"));
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_WordsExistInExclude_RemovedFromExcludeAddedToPersonal)
+{
+    enchant_dict_remove(_dict, "hello", -1);
+    enchant_dict_remove(_dict, "world", -1);
+    CHECK(ExcludeFileHasContents());
+
+    const char* words[] = { "hello", "world" };
+    enchant_dict_add_many(_dict, words, NULL, 2);
+    CHECK(!ExcludeFileHasContents());
+    CHECK(IsWordInDictionary("hello"));
+    CHECK(IsWordInDictionary("world"));
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_IsPermanent)
+{
+    const char* words[] = { "hello", "world" };
+    enchant_dict_add_many(_dict, words, NULL, 2);
+
+    ReloadTestDictionary();
+
+    CHECK(IsWordInDictionary("hello"));
+    CHECK(IsWordInDictionary("world"));
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_NoWords_NothingAdded)
+{
+    enchant_dict_add_many(_dict, NULL, NULL, 0);
+    CHECK(wordsAdded.empty());
+    CHECK(!PersonalWordListFileHasContents());
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture, 
+             EnchantDictionaryAddMany_HasPreviousError_ErrorCleared)
+{
+    SetErrorOnMockDictionary("something bad happened");
+
+    const char* words[] = { "hello" };
+    enchant_dict_add_many(_dict, words, NULL, 1);
+    CHECK_EQUAL((void*)NULL, (void*)enchant_dict_get_error(_dict));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Error Conditions
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_NullDictionary_NotAdded)
+{
+    const char* words[] = { "hello" };
+    enchant_dict_add_many(NULL, words, NULL, 1);
+    CHECK(wordsAdded.empty());
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_NullWords_NotAdded)
+{
+    enchant_dict_add_many(_dict, NULL, NULL, 1);
+    CHECK(wordsAdded.empty());
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_NullWord_NoneAdded)
+{
+    const char* words[] = { "hello", NULL };
+    enchant_dict_add_many(_dict, words, NULL, 2);
+    CHECK(wordsAdded.empty());
+    CHECK(!IsWordInDictionary("hello"));
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_EmptyWord_NoneAdded)
+{
+    const char* words[] = { "hello", "" };
+    enchant_dict_add_many(_dict, words, NULL, 2);
+    CHECK(wordsAdded.empty());
+    CHECK(!PersonalWordListFileHasContents());
+}
+
+TEST_FIXTURE(EnchantDictionaryAddMany_TestFixture,
+             EnchantDictionaryAddMany_InvalidUtf8Word_NoneAdded)
+{
+    const char* words[] = { "hello", "\xa5\xf1\x08" };
+    enchant_dict_add_many(_dict, words, NULL, 2);
+    CHECK(wordsAdded.empty());
+    CHECK(!IsWordInDictionary("hello"));
+}
@@ -22,6 +22,7 @@
 #include <UnitTest++/UnitTest++.h>
 #include <enchant.h>
 #include "EnchantDictionaryTestFixture.h"
+#include "AllocationCounter.h"
 
 static bool addToSessionCalled;
 static std::string wordToAdd;
@@ -219,3 +220,41 @@ TEST_FIXTURE(EnchantDictionaryAddToSessionNotImplemented_TestFixture,
     enchant_dict_add_to_session(_dict, "hello", -1);
     CHECK(!addToSessionCalled);
 }
+
+TEST_FIXTURE(EnchantDictionaryAddToSessionNotImplemented_TestFixture,
+             EnchantDictionaryAddToSessionNotImplemented_ManyWords_AllInSession)
+{
+    std::vector<std::string> words;
+    for(int i = 0; i < 500; ++i)
+    {
+        words.push_back("word" + std::string(1, (char)('a' + i % 26)) + std::string(1, (char)('a' + i / 26)));
+        enchant_dict_add_to_session(_dict, words.back().c_str(), -1);
+    }
+    enchant_dict_remove_from_session(_dict, words[7].c_str(), -1);
+
+    for(size_t i = 0; i < words.size(); ++i)
+        CHECK_EQUAL(i != 7, IsWordInSession(words[i]));
+    CHECK(!IsWordInSession("word"));
+    CHECK(!IsWordInSession("wordaaa"));
+}
+
+#ifdef ENCHANT_TEST_COUNT_ALLOCATIONS
+TEST_FIXTURE(EnchantDictionaryAddToSessionNotImplemented_TestFixture,
+             EnchantDictionaryAddToSessionNotImplemented_LookedUp_DoesNotAllocate)
+{
+    enchant_dict_add_to_session(_dict, "hello", -1);
+    enchant_dict_remove_from_session(_dict, "goodbye", -1);
+
+    nAllocations = 0;
+    countAllocations = true;
+    int added = enchant_dict_is_added(_dict, "hello", -1);
+    int addedPrefix = enchant_dict_is_added(_dict, "hellothere", 5);
+    int removed = enchant_dict_is_removed(_dict, "goodbye", -1);
+    countAllocations = false;
+
+    CHECK(added);
+    CHECK(addedPrefix);
+    CHECK(removed);
+    CHECK_EQUAL(0, nAllocations);
+}
+#endif
@@ -0,0 +1,339 @@
+/* Copyright (c) 2026 Enchant contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <UnitTest++/UnitTest++.h>
+#include <enchant.h>
+#include <string>
+#include <vector>
+#include "EnchantDictionaryTestFixture.h"
+
+static int dictCheckCalls;
+static int dictCheckBatchCalls;
+static std::vector<std::string> dictCheckBatchWords;
+
+static int
+MockDictionaryCheck (EnchantDict *, const char *const word, size_t len)
+{
+    dictCheckCalls++;
+    if(strncmp("hello", word, len)==0)
+    {
+        return 0; //good word
+    }
+    return 1; // bad word
+}
+
+static void
+MockDictionaryCheckBatch (EnchantDict *, const char *const *const words, const size_t * lens,
+                          size_t n_words, int * results)
+{
+    dictCheckBatchCalls++;
+    for(size_t i=0; i<n_words; ++i)
+    {
+        dictCheckBatchWords.push_back(std::string(words[i], lens[i]));
+        results[i] = std::string(words[i], lens[i]) == "hello" ? 0 : 1;
+    }
+}
+
+static EnchantDict* MockProviderRequestCheckMockDictionary(EnchantProvider * me, const char *tag)
+{
+    EnchantDict* dict = MockProviderRequestEmptyMockDictionary(me, tag);
+    dict->check = MockDictionaryCheck;
+    return dict;
+}
+
+static EnchantDict* MockProviderRequestCheckBatchMockDictionary(EnchantProvider * me, const char *tag)
+{
+    EnchantDict* dict = MockProviderRequestCheckMockDictionary(me, tag);
+    dict->check_batch = MockDictionaryCheckBatch;
+    return dict;
+}
+
+static void DictionaryCheckMany_ProviderConfiguration (EnchantProvider * me, const char *)
+{
+     me->request_dict = MockProviderRequestCheckMockDictionary;
+     me->dispose_dict = MockProviderDisposeDictionary;
+}
+
+static void DictionaryCheckBatch_ProviderConfiguration (EnchantProvider * me, const char *)
+{
+     me->request_dict = MockProviderRequestCheckBatchMockDictionary;
+     me->dispose_dict = MockProviderDisposeDictionary;
+}
+
+struct EnchantDictionaryCheckMany_TestFixture : EnchantDictionaryTestFixture
+{
+    //Setup
+    EnchantDictionaryCheckMany_TestFixture(ConfigureHook userConfiguration=DictionaryCheckMany_ProviderConfiguration):
+            EnchantDictionaryTestFixture(userConfiguration)
+    {
+        dictCheckCalls = 0;
+        dictCheckBatchCalls = 0;
+        dictCheckBatchWords.clear();
+    }
+
+    std::vector<int> CheckMany(EnchantDict* dict, const std::vector<std::string>& words)
+    {
+        std::vector<const char*> wordPointers;
+        for(size_t i=0; i<words.size(); ++i)
+        {
+            wordPointers.push_back(words[i].c_str());
+        }
+
+        std::vector<int> results(words.size(), 42);
+        enchant_dict_check_many(dict, wordPointers.empty() ? NULL : &wordPointers[0], NULL,
+                                words.size(), results.empty() ? NULL : &results[0]);
+        return results;
+    }
+
+    std::vector<int> CheckMany(const std::vector<std::string>& words)
+    {
+        return CheckMany(_dict, words);
+    }
+};
+
+struct EnchantDictionaryCheckBatch_TestFixture : EnchantDictionaryCheckMany_TestFixture
+{
+    //Setup
+    EnchantDictionaryCheckBatch_TestFixture():
+            EnchantDictionaryCheckMany_TestFixture(DictionaryCheckBatch_ProviderConfiguration)
+    { }
+};
+
+struct EnchantDictionaryCheckManyNotImplemented_TestFixture : EnchantDictionaryCheckMany_TestFixture
+{
+    //Setup
+    EnchantDictionaryCheckManyNotImplemented_TestFixture():
+            EnchantDictionaryCheckMany_TestFixture(EmptyDictionary_ProviderConfiguration)
+    { }
+};
+
+static std::vector<std::string> Words(const char* a, const char* b, const char* c)
+{
+    std::vector<std::string> words;
+    words.push_back(a);
+    words.push_back(b);
+    words.push_back(c);
+    return words;
+}
+
+/**
+ * enchant_dict_check_many
+ * @dict: A non-null #EnchantDict
+ * @words: The non-null words you wish to check, in UTF-8 encoding
+ * @lens: The byte lengths of @words, each -1 for strlen of the word, or %null for strlen of all of them
+ * @n_words: The number of @words
+ * @results: The location to store the @n_words results
+ *
+ * Checks the words as enchant_dict_check() would, storing what it would
+ * return for each in @results, but hands the words the dictionary cannot
+ * answer itself to the provider at once. Every result is negative if any
+ * of the words is empty or not valid UTF-8.
+ */
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Normal Operation
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_SameAsCheck)
+{
+    std::vector<int> results = CheckMany(Words("hello", "helo", "wrold"));
+
+    CHECK_EQUAL(3, results.size());
+    CHECK_EQUAL(enchant_dict_check(_dict, "hello", -1), results[0]);
+    CHECK_EQUAL(enchant_dict_check(_dict, "helo", -1), results[1]);
+    CHECK_EQUAL(enchant_dict_check(_dict, "wrold", -1), results[2]);
+    CHECK_EQUAL(0, results[0]);
+    CHECK_EQUAL(1, results[1]);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_LensSpecified)
+{
+    const char *words[] = { "hellodisregard me", "helo" };
+    ssize_t lens[] = { 5, -1 };
+    int results[2];
+    enchant_dict_check_many(_dict, words, lens, 2, results);
+
+    CHECK_EQUAL(0, results[0]);
+    CHECK_EQUAL(1, results[1]);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_NoBatchHook_ChecksEachWord)
+{
+    enchant_dict_set_check_cache_size(_dict, 0);
+    CheckMany(Words("hello", "helo", "wrold"));
+
+    CHECK_EQUAL(3, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_WordsInSessionOrLists_NotChecked)
+{
+    enchant_dict_add_to_session(_dict, "helo", -1);
+    enchant_dict_remove(_dict, "hello", -1);
+    AddWordToDictionary("wrold");
+    std::vector<int> results = CheckMany(Words("hello", "helo", "wrold"));
+
+    CHECK_EQUAL(1, results[0]);
+    CHECK_EQUAL(0, results[1]);
+    CHECK_EQUAL(0, results[2]);
+    CHECK_EQUAL(0, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_ResultsCached)
+{
+    CheckMany(Words("hello", "helo", "wrold"));
+    CHECK_EQUAL(3, dictCheckCalls);
+
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "helo", -1));
+    CHECK_EQUAL(3, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_RepeatedWord_CachedOnce)
+{
+    std::vector<int> results = CheckMany(Words("hello", "helo", "hello"));
+    CHECK_EQUAL(0, results[0]);
+    CHECK_EQUAL(0, results[2]);
+
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "helo", -1));
+    CHECK_EQUAL(3, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckBatch_TestFixture,
+             EnchantDictionaryCheckBatch_CallsHookOnce)
+{
+    std::vector<int> results = CheckMany(Words("hello", "helo", "wrold"));
+
+    CHECK_EQUAL(1, dictCheckBatchCalls);
+    CHECK_EQUAL(0, dictCheckCalls);
+    CHECK_EQUAL(3, dictCheckBatchWords.size());
+    CHECK_EQUAL(0, results[0]);
+    CHECK_EQUAL(1, results[1]);
+    CHECK_EQUAL(1, results[2]);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckBatch_TestFixture,
+             EnchantDictionaryCheckBatch_KnownWords_NotHandedToHook)
+{
+    enchant_dict_add_to_session(_dict, "helo", -1);
+    enchant_dict_check(_dict, "hello", -1);
+    std::vector<int> results = CheckMany(Words("hello", "helo", "wrold"));
+
+    CHECK_EQUAL(1, dictCheckBatchWords.size());
+    if(dictCheckBatchWords.size() == 1)
+    {
+        CHECK_EQUAL("wrold", dictCheckBatchWords[0]);
+    }
+    CHECK_EQUAL(0, results[0]);
+    CHECK_EQUAL(0, results[1]);
+    CHECK_EQUAL(1, results[2]);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckBatch_TestFixture,
+             EnchantDictionaryCheckBatch_AllWordsKnown_HookNotCalled)
+{
+    enchant_dict_add_to_session(_dict, "helo", -1);
+    CheckMany(Words("helo", "helo", "helo"));
+
+    CHECK_EQUAL(0, dictCheckBatchCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_InBrokerPwl)
+{
+    enchant_dict_add(_pwl, "hello", -1);
+    std::vector<int> results = CheckMany(_pwl, Words("hello", "helo", "wrold"));
+
+    CHECK_EQUAL(0, results[0]);
+    CHECK_EQUAL(1, results[1]);
+    CHECK_EQUAL(1, results[2]);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckManyNotImplemented_TestFixture,
+             EnchantDictionaryCheckManyNotImplemented_Negative)
+{
+    std::vector<int> results = CheckMany(Words("hello", "helo", "wrold"));
+
+    CHECK(results[0] < 0);
+    CHECK(results[1] < 0);
+    CHECK(results[2] < 0);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_NoWords_DoNothing)
+{
+    enchant_dict_check_many(_dict, NULL, NULL, 0, NULL);
+    CHECK_EQUAL(0, dictCheckCalls);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Error Conditions
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_NullDictionary_DoNothing)
+{
+    const char *words[] = { "hello" };
+    int results[1];
+    enchant_dict_check_many(NULL, words, NULL, 1, results);
+    CHECK_EQUAL(0, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_NullWords_DoNothing)
+{
+    int results[1];
+    enchant_dict_check_many(_dict, NULL, NULL, 1, results);
+    CHECK_EQUAL(0, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_NullResults_DoNothing)
+{
+    const char *words[] = { "hello" };
+    enchant_dict_check_many(_dict, words, NULL, 1, NULL);
+    CHECK_EQUAL(0, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_EmptyWord_AllNegative)
+{
+    std::vector<int> results = CheckMany(Words("hello", "", "helo"));
+
+    CHECK(results[0] < 0);
+    CHECK(results[1] < 0);
+    CHECK(results[2] < 0);
+    CHECK_EQUAL(0, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckMany_TestFixture,
+             EnchantDictionaryCheckMany_InvalidUtf8Word_AllNegative)
+{
+    std::vector<int> results = CheckMany(Words("hello", "\xa5\xf1\x08", "helo"));
+
+    CHECK(results[0] < 0);
+    CHECK(results[1] < 0);
+    CHECK(results[2] < 0);
+    CHECK_EQUAL(0, dictCheckCalls);
+}
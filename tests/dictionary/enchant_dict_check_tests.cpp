@@ -222,3 +222,49 @@ TEST_FIXTURE(EnchantDictionaryCheck_TestFixture,
 	ReloadTestDictionary();
 	CHECK_EQUAL(1, enchant_dict_check(_dict, "hello", -1));
 }
+
+TEST_FIXTURE(EnchantDictionaryCheck_TestFixture,
+             EnchantDictionaryCheck_ExcludeFileNotCreated)
+{
+    g_remove(GetExcludeDictFileName().c_str());
+    ReloadTestDictionary();
+
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    enchant_dict_add(_dict, "personal", -1);
+    CHECK(!g_file_test(GetExcludeDictFileName().c_str(), G_FILE_TEST_EXISTS));
+
+    enchant_dict_remove(_dict, "hello", -1);
+    CHECK(g_file_test(GetExcludeDictFileName().c_str(), G_FILE_TEST_EXISTS));
+}
+
+TEST_FIXTURE(EnchantDictionaryCheck_TestFixture,
+             EnchantDictionaryCheck_ExcludeFileCreatedLater_WordExcluded)
+{
+    g_remove(GetExcludeDictFileName().c_str());
+    ReloadTestDictionary();
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+
+    ExternalAddWordToExclude("hello");
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "hello", -1));
+}
+
+TEST_FIXTURE(EnchantDictionaryCheck_TestFixture,
+             EnchantDictionaryCheck_WordInPersonalRemovedFromSession_1_DoesNotCallProvider)
+{
+    enchant_dict_add(_dict, "personal", -1);
+    enchant_dict_remove_from_session(_dict, "personal", -1);
+
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "personal", -1));
+    CHECK(!dictCheckCalled);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheck_TestFixture,
+             EnchantDictionaryCheck_WordInExcludeAddedToSession_0_DoesNotCallProvider)
+{
+    ExternalAddWordToExclude("hello");
+    ReloadTestDictionary();
+    enchant_dict_add_to_session(_dict, "hello", -1);
+
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    CHECK(!dictCheckCalled);
+}
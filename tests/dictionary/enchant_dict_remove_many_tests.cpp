@@ -0,0 +1,200 @@
+/* Copyright (c) 2026 Enchant contributors
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include <enchant.h>
+#include <fstream>
+
+#include "EnchantDictionaryTestFixture.h"
+
+static std::vector<std::string> wordsExcluded;
+
+static void
+MockDictionaryAddToExclude (EnchantDict *, const char *const word, size_t len)
+{
+    wordsExcluded.push_back(std::string(word, len));
+}
+
+static int
+MockDictionaryCheck (EnchantDict *, const char *const word, size_t len)
+{
+    if(std::string(word, len) == "hello" || std::string(word, len) == "world")
+    {
+        return 0; //good word
+    }
+    return 1; // bad word
+}
+
+static EnchantDict* MockProviderRequestAddToExcludeMockDictionary(EnchantProvider * me, const char *tag)
+{
+    EnchantDict* dict = MockProviderRequestBasicMockDictionary(me, tag);
+    dict->add_to_exclude = MockDictionaryAddToExclude;
+    dict->check = MockDictionaryCheck;
+    return dict;
+}
+
+static void DictionaryAddToExclude_ProviderConfiguration (EnchantProvider * me, const char *)
+{
+     me->request_dict = MockProviderRequestAddToExcludeMockDictionary;
+     me->dispose_dict = MockProviderDisposeDictionary;
+}
+
+struct EnchantDictionaryRemoveMany_TestFixture : EnchantDictionaryTestFixture
+{
+    //Setup
+    EnchantDictionaryRemoveMany_TestFixture():
+            EnchantDictionaryTestFixture(DictionaryAddToExclude_ProviderConfiguration)
+    { 
+        wordsExcluded.clear();
+    }
+
+    size_t CountLines(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str());
+        std::string line;
+        size_t n_lines = 0;
+        while(std::getline(file, line))
+            ++n_lines;
+        return n_lines;
+    }
+};
+
+/**
+ * enchant_dict_remove_many
+ * @dict: A non-null #EnchantDict
+ * @words: The words you wish to add to your exclude dictionary and remove
+ *         from the personal dictionary, in UTF-8 encoding
+ * @lens: The byte lengths of @words, each -1 for strlen, or NULL for all strlen
+ * @n_words: The number of @words
+ */
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Normal Operation
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_WordsNoLongerExistInDictionary)
+{
+    CHECK(IsWordInDictionary("hello"));
+    CHECK(IsWordInDictionary("world"));
+
+    const char* words[] = { "hello", "world" };
+    enchant_dict_remove_many(_dict, words, NULL, 2);
+    CHECK(!IsWordInDictionary("hello"));
+    CHECK(!IsWordInDictionary("world"));
+}
+
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_WordsNoLongerExistInSession)
+{
+    const char* words[] = { "hello", "world" };
+    enchant_dict_add_many(_dict, words, NULL, 2);
+    enchant_dict_remove_many(_dict, words, NULL, 2);
+    CHECK(!IsWordInSession("hello"));
+    CHECK(!IsWordInSession("world"));
+}
+
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_OneLinePerWordInEnchantExcludeFile)
+{
+    const char* words[] = { "hello", "world", "hello" };
+    enchant_dict_remove_many(_dict, words, NULL, 3);
+    CHECK_EQUAL(2u, CountLines(GetExcludeDictFileName()));
+}
+
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_WordsRemovedFromEnchantPwlFile)
+{
+    const char* words[] = { "hello", "world" };
+    enchant_dict_add_many(_dict, words, NULL, 2);
+    CHECK(PersonalWordListFileHasContents());
+    enchant_dict_remove_many(_dict, words, NULL, 2);
+    CHECK(!PersonalWordListFileHasContents());
+}
+
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_SomeWordsRemoved_OthersKept)
+{
+    const char* added[] = { "hello", "world", "again" };
+    enchant_dict_add_many(_dict, added, NULL, 3);
+
+    const char* removed[] = { "world", "unknown" };
+    enchant_dict_remove_many(_dict, removed, NULL, 2);
+
+    ReloadTestDictionary();
+
+    CHECK(IsWordInDictionary("hello"));
+    CHECK(!IsWordInDictionary("world"));
+    CHECK(IsWordInDictionary("again"));
+    CHECK(!IsWordInDictionary("unknown"));
+}
+
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_PassedOnToProvider_LensSpecified)
+{
+    const char* words[] = { "hellodisregard me", "world" };
+    ssize_t lens[] = { 5, -1 };
+    enchant_dict_remove_many(_dict, words, lens, 2);
+    CHECK_EQUAL(2u, wordsExcluded.size());
+    CHECK_EQUAL(std::string("hello"), wordsExcluded[0]);
+    CHECK_EQUAL(std::string("world"), wordsExcluded[1]);
+}
+
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_NoWords_NothingRemoved)
+{
+    enchant_dict_remove_many(_dict, NULL, NULL, 0);
+    CHECK(wordsExcluded.empty());
+    CHECK(!ExcludeFileHasContents());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Error Conditions
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_NullDictionary_NotRemoved)
+{
+    const char* words[] = { "hello" };
+    enchant_dict_remove_many(NULL, words, NULL, 1);
+    CHECK(wordsExcluded.empty());
+}
+
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_NullWords_NotRemoved)
+{
+    enchant_dict_remove_many(_dict, NULL, NULL, 1);
+    CHECK(wordsExcluded.empty());
+}
+
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_EmptyWord_NoneRemoved)
+{
+    const char* words[] = { "hello", "" };
+    enchant_dict_remove_many(_dict, words, NULL, 2);
+    CHECK(wordsExcluded.empty());
+    CHECK(IsWordInDictionary("hello"));
+}
+
+TEST_FIXTURE(EnchantDictionaryRemoveMany_TestFixture,
+             EnchantDictionaryRemoveMany_InvalidUtf8Word_NoneRemoved)
+{
+    const char* words[] = { "hello", "\xa5\xf1\x08" };
+    enchant_dict_remove_many(_dict, words, NULL, 2);
+    CHECK(wordsExcluded.empty());
+    CHECK(IsWordInDictionary("hello"));
+}
@@ -0,0 +1,235 @@
+/* Copyright (c) 2026 Enchant contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include <enchant.h>
+#include <locale.h>
+#include "EnchantDictionaryTestFixture.h"
+
+static int dictCheckCalls;
+
+static int
+MockDictionaryCheck (EnchantDict *, const char *const word, size_t len)
+{
+    dictCheckCalls++;
+    if(strncmp("hello", word, len)==0)
+    {
+        return 0; //good word
+    }
+    return 1; // bad word
+}
+
+static EnchantDict* MockProviderRequestCheckMockDictionary(EnchantProvider * me, const char *tag)
+{
+    EnchantDict* dict = MockProviderRequestEmptyMockDictionary(me, tag);
+    dict->check = MockDictionaryCheck;
+    return dict;
+}
+
+static void DictionaryCheckCache_ProviderConfiguration (EnchantProvider * me, const char *)
+{
+     me->request_dict = MockProviderRequestCheckMockDictionary;
+     me->dispose_dict = MockProviderDisposeDictionary;
+}
+
+struct EnchantDictionaryCheckCache_TestFixture : EnchantDictionaryTestFixture
+{
+    //Setup
+    EnchantDictionaryCheckCache_TestFixture():
+            EnchantDictionaryTestFixture(DictionaryCheckCache_ProviderConfiguration)
+    {
+        dictCheckCalls = 0;
+    }
+
+    size_t GetHits()
+    {
+        size_t n_hits, n_misses;
+        enchant_dict_get_check_cache_stats(_dict, &n_hits, &n_misses);
+        return n_hits;
+    }
+
+    size_t GetMisses()
+    {
+        size_t n_hits, n_misses;
+        enchant_dict_get_check_cache_stats(_dict, &n_hits, &n_misses);
+        return n_misses;
+    }
+};
+
+/**
+ * enchant_dict_set_check_cache_size
+ * @dict: A non-null #EnchantDict
+ * @n_entries: The most results of enchant_dict_check() to remember, or 0 for none
+ *
+ * Sets how many results of enchant_dict_check() the dictionary remembers,
+ * forgetting those it has. The words checked most often are kept. They are
+ * all forgotten when a word is added to or removed from the dictionary or
+ * session, or when the personal or exclude dictionary changes otherwise.
+ * By default 4096 results are remembered.
+ */
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Normal Operation
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_CheckedTwice_CallsProviderOnce)
+{
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "helo", -1));
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "helo", -1));
+
+    CHECK_EQUAL(2, dictCheckCalls);
+    CHECK_EQUAL(2, GetHits());
+    CHECK_EQUAL(2, GetMisses());
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_Disabled_CallsProviderEachTime)
+{
+    enchant_dict_set_check_cache_size(_dict, 0);
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+
+    CHECK_EQUAL(2, dictCheckCalls);
+    CHECK_EQUAL(0, GetHits());
+    CHECK_EQUAL(0, GetMisses());
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_Full_EvictsResults)
+{
+    enchant_dict_set_check_cache_size(_dict, 1);
+    enchant_dict_check(_dict, "hello", -1);
+    enchant_dict_check(_dict, "helo", -1);
+    enchant_dict_check(_dict, "hello", -1);
+
+    CHECK_EQUAL(3, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_WordAdded_CapitalizedFormRechecked)
+{
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "Helo", -1));
+    enchant_dict_add(_dict, "helo", -1);
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "Helo", -1));
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_NonAsciiWordAdded_CapitalizedFormRechecked)
+{
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "H\xc3\xa9lo", -1)); // u00e9 = Latin small letter e with acute
+    enchant_dict_add(_dict, "h\xc3\xa9lo", -1);
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "H\xc3\xa9lo", -1));
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_WordsAddedMany_Rechecked)
+{
+    const char *words[] = { "helo", "wrold" };
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "wrold", -1));
+    enchant_dict_add_many(_dict, words, NULL, 2);
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "wrold", -1));
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_WordRemoved_Rechecked)
+{
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    enchant_dict_remove(_dict, "hello", -1);
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "hello", -1));
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_WordAddedToSession_Rechecked)
+{
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "helo", -1));
+    enchant_dict_add_to_session(_dict, "helo", -1);
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "helo", -1));
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_WordRemovedFromSession_Rechecked)
+{
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    enchant_dict_remove_from_session(_dict, "hello", -1);
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "hello", -1));
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_OtherWordAdded_Rechecked)
+{
+    enchant_dict_check(_dict, "hello", -1);
+    enchant_dict_add(_dict, "helo", -1);
+    enchant_dict_check(_dict, "hello", -1);
+
+    CHECK_EQUAL(2, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_TurkishLocale_WordAdded_CapitalizedFormRechecked)
+{
+    std::string oldLocale(setlocale(LC_ALL, NULL));
+    if(setlocale(LC_ALL, "tr_TR.UTF-8") == NULL)
+        return;
+
+    // u0131 = Latin small letter dotless i, which is "I" in lower case here
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "I", -1));
+    enchant_dict_add(_dict, "\xc4\xb1", -1);
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "I", -1));
+
+    setlocale(LC_ALL, oldLocale.c_str());
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_PersonalFileChanged_Rechecked)
+{
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "helo", -1));
+    ExternalAddWordToDictionary("helo");
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "helo", -1));
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_ExcludeFileChanged_Rechecked)
+{
+    CHECK_EQUAL(0, enchant_dict_check(_dict, "hello", -1));
+    ExternalAddWordToExclude("hello");
+    CHECK_EQUAL(1, enchant_dict_check(_dict, "hello", -1));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Error Conditions
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_NullDictionary_DoNothing)
+{
+    enchant_dict_set_check_cache_size(NULL, 1);
+    enchant_dict_check(_dict, "hello", -1);
+    enchant_dict_check(_dict, "hello", -1);
+
+    CHECK_EQUAL(1, dictCheckCalls);
+}
+
+TEST_FIXTURE(EnchantDictionaryCheckCache_TestFixture,
+             EnchantDictionaryCheckCache_Stats_NullCounts_DoNothing)
+{
+    enchant_dict_check(_dict, "hello", -1);
+    enchant_dict_get_check_cache_stats(_dict, NULL, NULL);
+    enchant_dict_get_check_cache_stats(NULL, NULL, NULL);
+}
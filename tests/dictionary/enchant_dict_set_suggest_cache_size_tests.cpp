@@ -0,0 +1,278 @@
+/* Copyright (c) 2026 Enchant contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include <enchant.h>
+#include <algorithm>
+#include "EnchantDictionaryTestFixture.h"
+
+static int dictSuggestCalls;
+
+static char **
+CountingMockDictionarySuggest (EnchantDict * dict, const char *const word, size_t len, size_t * out_n_suggs)
+{
+    dictSuggestCalls++;
+    return MockDictionarySuggest(dict, word, len, out_n_suggs);
+}
+
+static void
+MockDictionaryStoreReplacement (EnchantDict *, const char *const, size_t, const char *const, size_t)
+{
+}
+
+static EnchantDict* MockProviderRequestSuggestMockDictionary(EnchantProvider * me, const char *tag)
+{
+    EnchantDict* dict = MockProviderRequestEmptyMockDictionary(me, tag);
+    dict->suggest = CountingMockDictionarySuggest;
+    dict->store_replacement = MockDictionaryStoreReplacement;
+    return dict;
+}
+
+static void DictionarySuggestCache_ProviderConfiguration (EnchantProvider * me, const char *)
+{
+     me->request_dict = MockProviderRequestSuggestMockDictionary;
+     me->dispose_dict = MockProviderDisposeDictionary;
+}
+
+struct EnchantDictionarySuggestCache_TestFixture : EnchantDictionaryTestFixture
+{
+    //Setup
+    EnchantDictionarySuggestCache_TestFixture():
+            EnchantDictionaryTestFixture(DictionarySuggestCache_ProviderConfiguration)
+    {
+        dictSuggestCalls = 0;
+    }
+
+    size_t GetHits()
+    {
+        size_t n_hits, n_misses;
+        enchant_dict_get_suggest_cache_stats(_dict, &n_hits, &n_misses);
+        return n_hits;
+    }
+
+    size_t GetMisses()
+    {
+        size_t n_hits, n_misses;
+        enchant_dict_get_suggest_cache_stats(_dict, &n_hits, &n_misses);
+        return n_misses;
+    }
+};
+
+/**
+ * enchant_dict_set_suggest_cache_size
+ * @dict: A non-null #EnchantDict
+ * @n_entries: The most results of enchant_dict_suggest() to remember, or 0 for none
+ * @n_bytes: The most bytes the remembered results may take, or 0 for none
+ *
+ * Sets how many results of enchant_dict_suggest() the dictionary remembers,
+ * forgetting those it has. The results asked for last are kept, and are
+ * copied for each call. They are all forgotten when a word is added to or
+ * removed from the dictionary or session, when the personal or exclude
+ * dictionary changes otherwise, or when a replacement is stored. By default
+ * 128 results are remembered, in up to 64 KiB.
+ */
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Normal Operation
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_SuggestedTwice_CallsProviderOnce)
+{
+    std::vector<std::string> first = GetSuggestionsFromWord("helo");
+    std::vector<std::string> second = GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(1, dictSuggestCalls);
+    CHECK_EQUAL(GetExpectedSuggestions("helo").size(), second.size());
+    CHECK_ARRAY_EQUAL(first, second, std::min(first.size(), second.size()));
+    CHECK_EQUAL(1, GetHits());
+    CHECK_EQUAL(1, GetMisses());
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_ReturnsCopy)
+{
+    char** first = enchant_dict_suggest(_dict, "helo", -1, NULL);
+    char** second = enchant_dict_suggest(_dict, "helo", -1, NULL);
+
+    CHECK(first != second);
+    CHECK(first[0] != second[0]);
+    FreeStringList(first);
+    FreeStringList(second);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_LenSpecified_KeyedByExactInput)
+{
+    GetSuggestionsFromWord("helo");
+    size_t cSuggestions;
+    char** suggestions = enchant_dict_suggest(_dict, "helodisregard me", 4, &cSuggestions);
+    FreeStringList(suggestions);
+    suggestions = enchant_dict_suggest(_dict, "hel", -1, &cSuggestions);
+    FreeStringList(suggestions);
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_Disabled_CallsProviderEachTime)
+{
+    enchant_dict_set_suggest_cache_size(_dict, 0, 0);
+    GetSuggestionsFromWord("helo");
+    GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+    CHECK_EQUAL(0, GetHits());
+    CHECK_EQUAL(0, GetMisses());
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_FullOfEntries_EvictsLeastRecentlyUsed)
+{
+    enchant_dict_set_suggest_cache_size(_dict, 2, 64 * 1024);
+    GetSuggestionsFromWord("helo");
+    GetSuggestionsFromWord("wrold");
+    GetSuggestionsFromWord("helo");
+    GetSuggestionsFromWord("teh");
+    CHECK_EQUAL(3, dictSuggestCalls);
+
+    GetSuggestionsFromWord("helo");
+    CHECK_EQUAL(3, dictSuggestCalls);
+    GetSuggestionsFromWord("wrold");
+    CHECK_EQUAL(4, dictSuggestCalls);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_TooFewBytes_NotCached)
+{
+    enchant_dict_set_suggest_cache_size(_dict, 128, 16);
+    GetSuggestionsFromWord("helo");
+    GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_WordAdded_Resuggested)
+{
+    GetSuggestionsFromWord("helo");
+    AddWordToDictionary("hello");
+    std::vector<std::string> suggestions = GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+    CHECK(std::find(suggestions.begin(), suggestions.end(), "hello") != suggestions.end());
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_WordRemoved_Resuggested)
+{
+    GetSuggestionsFromWord("helo");
+    RemoveWordFromDictionary("aelo");
+    std::vector<std::string> suggestions = GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+    CHECK(std::find(suggestions.begin(), suggestions.end(), "aelo") == suggestions.end());
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_WordRemovedFromSession_Resuggested)
+{
+    GetSuggestionsFromWord("helo");
+    enchant_dict_remove_from_session(_dict, "aelo", -1);
+    std::vector<std::string> suggestions = GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+    CHECK(std::find(suggestions.begin(), suggestions.end(), "aelo") == suggestions.end());
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_WordAddedToSession_Resuggested)
+{
+    GetSuggestionsFromWord("helo");
+    enchant_dict_add_to_session(_dict, "hello", -1);
+    GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_ReplacementStored_Resuggested)
+{
+    GetSuggestionsFromWord("helo");
+    enchant_dict_store_replacement(_dict, "helo", -1, "hello", -1);
+    GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_PersonalFileChanged_Resuggested)
+{
+    GetSuggestionsFromWord("helo");
+    ExternalAddWordToDictionary("hello");
+    std::vector<std::string> suggestions = GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+    CHECK(std::find(suggestions.begin(), suggestions.end(), "hello") != suggestions.end());
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_WordRemovedFromPersonalFile_Resuggested)
+{
+    enchant_dict_add(_dict, "hello", -1);
+    std::vector<std::string> suggestions = GetSuggestionsFromWord("helo");
+    CHECK(std::find(suggestions.begin(), suggestions.end(), "hello") != suggestions.end());
+
+    ExternalAddWordToDictionary("#enchant-remove:hello");
+    suggestions = GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+    CHECK(std::find(suggestions.begin(), suggestions.end(), "hello") == suggestions.end());
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_ExcludeFileChanged_Resuggested)
+{
+    GetSuggestionsFromWord("helo");
+    ExternalAddWordToExclude("aelo");
+    std::vector<std::string> suggestions = GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(2, dictSuggestCalls);
+    CHECK(std::find(suggestions.begin(), suggestions.end(), "aelo") == suggestions.end());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Error Conditions
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_NullDictionary_DoNothing)
+{
+    enchant_dict_set_suggest_cache_size(NULL, 0, 0);
+    GetSuggestionsFromWord("helo");
+    GetSuggestionsFromWord("helo");
+
+    CHECK_EQUAL(1, dictSuggestCalls);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestCache_TestFixture,
+             EnchantDictionarySuggestCache_Stats_NullCounts_DoNothing)
+{
+    GetSuggestionsFromWord("helo");
+    enchant_dict_get_suggest_cache_stats(_dict, NULL, NULL);
+    enchant_dict_get_suggest_cache_stats(NULL, NULL, NULL);
+}
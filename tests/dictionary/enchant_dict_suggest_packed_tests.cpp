@@ -0,0 +1,213 @@
+/* Copyright (c) 2026 Enchant contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include <enchant.h>
+#include <vector>
+#include <algorithm>
+
+#include "EnchantDictionaryTestFixture.h"
+
+struct EnchantDictionarySuggestPacked_TestFixture : EnchantDictionaryTestFixture
+{
+    //Setup
+    EnchantDictionarySuggestPacked_TestFixture()
+    {
+        _suggestions = NULL;
+    }
+
+    //Teardown
+    ~EnchantDictionarySuggestPacked_TestFixture()
+    {
+        FreePackedStringList(_suggestions);
+    }
+
+    void FreePackedStringList(char** list)
+    {
+        if(list)
+        {
+            enchant_dict_free_packed_string_list(_dict, list);
+        }
+    }
+
+    std::vector<std::string> GetPackedSuggestions(const std::string& word)
+    {
+        std::vector<std::string> result;
+
+        size_t cSuggestions;
+        char** suggestions = enchant_dict_suggest_packed(_dict, word.c_str(), word.size(), &cSuggestions);
+        if(suggestions != NULL){
+            result.insert(result.begin(), suggestions, suggestions+cSuggestions);
+        }
+        FreePackedStringList(suggestions);
+
+        return result;
+    }
+
+    char** _suggestions;
+};
+
+struct EnchantDictionarySuggestPackedNotImplemented_TestFixture : EnchantDictionaryTestFixture
+{
+    //Setup
+    EnchantDictionarySuggestPackedNotImplemented_TestFixture():
+            EnchantDictionaryTestFixture(EmptyDictionary_ProviderConfiguration)
+    { }
+};
+
+/**
+ * enchant_dict_suggest_packed
+ * @dict: A non-null #EnchantDict
+ * @word: The non-null word you wish to find suggestions for, in UTF-8 encoding
+ * @len: The byte length of @word, or -1 for strlen (@word)
+ * @out_n_suggs: The location to store the # of suggestions returned, or %null
+ *
+ * Gives the suggestions enchant_dict_suggest() would, in one block of memory
+ * holding the list followed by the strings. Free it with
+ * enchant_dict_free_packed_string_list().
+ *
+ * Returns: A %null terminated list of UTF-8 encoded suggestions, or %null
+ */
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Normal Operation
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_LenComputed)
+{
+    size_t cSuggestions;
+    _suggestions = enchant_dict_suggest_packed(_dict, "helo", -1, &cSuggestions);
+    CHECK(_suggestions);
+    CHECK_EQUAL(4, cSuggestions);
+    CHECK_EQUAL((void*)NULL, (void*)_suggestions[cSuggestions]);
+
+    std::vector<std::string> suggestions;
+    if(_suggestions != NULL){
+        suggestions.insert(suggestions.begin(), _suggestions, _suggestions+cSuggestions);
+    }
+
+    CHECK_ARRAY_EQUAL(GetExpectedSuggestions("helo"), suggestions, std::min((size_t)4,cSuggestions));
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_LenSpecified)
+{
+    size_t cSuggestions;
+    _suggestions = enchant_dict_suggest_packed(_dict, "helodisregard me", 4, &cSuggestions);
+    CHECK(_suggestions);
+    CHECK_EQUAL(4, cSuggestions);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_StringsFollowList)
+{
+    size_t cSuggestions;
+    _suggestions = enchant_dict_suggest_packed(_dict, "helo", -1, &cSuggestions);
+    CHECK(_suggestions);
+
+    const char* end = (const char*)(_suggestions + cSuggestions + 1);
+    for(size_t i=0; _suggestions && i<cSuggestions; ++i){
+        CHECK_EQUAL((const void*)end, (const void*)_suggestions[i]);
+        end += strlen(_suggestions[i]) + 1;
+    }
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_SameAsSuggest)
+{
+    CHECK_EQUAL(GetSuggestionsFromWord("helo").size(), GetPackedSuggestions("helo").size());
+
+    std::vector<std::string> suggestions = GetSuggestionsFromWord("helo");
+    std::vector<std::string> packedSuggestions = GetPackedSuggestions("helo");
+    CHECK_ARRAY_EQUAL(suggestions, packedSuggestions,
+                      std::min(suggestions.size(), packedSuggestions.size()));
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_CacheDisabled_SameAsSuggest)
+{
+    enchant_dict_set_suggest_cache_size(_dict, 0, 0);
+
+    std::vector<std::string> suggestions = GetSuggestionsFromWord("helo");
+    std::vector<std::string> packedSuggestions = GetPackedSuggestions("helo");
+    CHECK_EQUAL(suggestions.size(), packedSuggestions.size());
+    CHECK_ARRAY_EQUAL(suggestions, packedSuggestions,
+                      std::min(suggestions.size(), packedSuggestions.size()));
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_InBrokerPwl)
+{
+    enchant_dict_add(_pwl, "hello", -1);
+    size_t cSuggestions;
+    char** suggestions = enchant_dict_suggest_packed(_pwl, "helo", -1, &cSuggestions);
+    CHECK(suggestions);
+    CHECK_EQUAL(1, cSuggestions);
+    if(suggestions)
+    {
+        CHECK_EQUAL("hello", suggestions[0]);
+        enchant_dict_free_packed_string_list(_pwl, suggestions);
+    }
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_FreeNull_DoNothing)
+{
+    enchant_dict_free_packed_string_list(_dict, NULL);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPackedNotImplemented_TestFixture,
+             EnchantDictionarySuggestPackedNotImplemented_NULL)
+{
+    size_t cSuggestions;
+    char** suggestions = enchant_dict_suggest_packed(_dict, "helo", -1, &cSuggestions);
+    CHECK(!suggestions);
+    CHECK_EQUAL(0, cSuggestions);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test Error Conditions
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_NullDictionary_NullSuggestions)
+{
+    _suggestions = enchant_dict_suggest_packed(NULL, "helo", -1, NULL);
+    CHECK(!_suggestions);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_NullWord_NullSuggestions)
+{
+    _suggestions = enchant_dict_suggest_packed(_dict, NULL, -1, NULL);
+    CHECK(!_suggestions);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_EmptyWord_NullSuggestions)
+{
+    _suggestions = enchant_dict_suggest_packed(_dict, "", -1, NULL);
+    CHECK(!_suggestions);
+}
+
+TEST_FIXTURE(EnchantDictionarySuggestPacked_TestFixture,
+             EnchantDictionarySuggestPacked_InvalidUtf8Word_NullSuggestions)
+{
+    _suggestions = enchant_dict_suggest_packed(_dict, "\xa5\xf1\x08", -1, NULL);
+    CHECK(!_suggestions);
+}
@@ -25,16 +25,21 @@
 #include <algorithm>
 
 #include "EnchantDictionaryTestFixture.h"
+#include "AllocationCounter.h"
 
 static bool dictSuggestCalled;
 std::string suggestWord;
+static char* providedSuggestions[8];
+static size_t cProvidedSuggestions;
 
 static enum SuggestBehavior{
     returnNull,
     returnZero,
     returnFour,
+    returnEight,
     returnFourOneInvalidUtf8,
-    returnFianceNfc
+    returnFianceNfc,
+    returnFianceNfcAndNfdTwice
 } suggestBehavior;
 
 struct EnchantDictionarySuggestTestFixtureBase : EnchantDictionaryTestFixture
@@ -81,9 +86,25 @@ MyMockDictionarySuggest (EnchantDict * dict, const char *const word, size_t len,
             sugg_arr = g_new0 (char *, *out_n_suggs + 1);
             sugg_arr[0] = g_strdup ("fianc\xc3\xa9");  // c3 a9 = utf8 for u00e9 = Latin small letter e with acute
             break;
+        case returnFianceNfcAndNfdTwice:
+            *out_n_suggs = 4;
+            sugg_arr = g_new0 (char *, *out_n_suggs + 1);
+            sugg_arr[0] = g_strdup ("fianc\xc3\xa9");
+            sugg_arr[1] = g_strdup ("fiance\xcc\x81");  // cc 81 = utf8 for u0301 = Combining acute accent
+            sugg_arr[2] = g_strdup ("fiance");
+            sugg_arr[3] = g_strdup ("fianc\xc3\xa9");
+            break;
         case returnFour:
             sugg_arr = MockDictionarySuggest(dict, word, len, out_n_suggs);
             break;
+        case returnEight:
+            *out_n_suggs = 8;
+            sugg_arr = g_new0 (char *, *out_n_suggs + 1);
+            for(size_t i=0; i<*out_n_suggs; ++i){
+                sugg_arr[i] = g_strndup (word, len);
+                sugg_arr[i][0] = 'a' + (char)i;
+            }
+            break;
         case returnFourOneInvalidUtf8:
             sugg_arr = MockDictionarySuggest(dict, word, len, out_n_suggs);
             g_free(sugg_arr[0]);
@@ -91,6 +112,11 @@ MyMockDictionarySuggest (EnchantDict * dict, const char *const word, size_t len,
             break;
     }
 
+    cProvidedSuggestions = 0;
+    for(size_t i=0; sugg_arr && i<*out_n_suggs && i<8; ++i){
+        providedSuggestions[cProvidedSuggestions++] = sugg_arr[i];
+    }
+
     return sugg_arr;
 }
 
@@ -369,6 +395,70 @@ TEST_FIXTURE(EnchantDictionarySuggest_TestFixture,
     CHECK_EQUAL(Convert(L"fianc\xe9"), _suggestions[0]);
 }
 
+TEST_FIXTURE(EnchantDictionarySuggest_TestFixture,
+             EnchantDictionarySuggest_SuggestionsFromDictionary_HandedOverUncopied)
+{
+    enchant_dict_set_suggest_cache_size(_dict, 0, 0);
+    size_t cSuggestions;
+    _suggestions = enchant_dict_suggest(_dict, "helo", -1, &cSuggestions);
+    CHECK(_suggestions);
+
+    CHECK_EQUAL(cProvidedSuggestions, cSuggestions);
+    for(size_t i=0; i<cSuggestions && i<cProvidedSuggestions; ++i){
+        CHECK_EQUAL((void*)providedSuggestions[i], (void*)_suggestions[i]);
+    }
+}
+
+#ifdef ENCHANT_TEST_COUNT_ALLOCATIONS
+static int CountSuggestAllocations(EnchantDict* dict, SuggestBehavior behavior)
+{
+    suggestBehavior = behavior;
+    nAllocations = 0;
+    countAllocations = true;
+    char** suggestions = enchant_dict_suggest(dict, "helo", -1, NULL);
+    countAllocations = false;
+    enchant_dict_free_string_list(dict, suggestions);
+    return nAllocations;
+}
+
+TEST_FIXTURE(EnchantDictionarySuggest_TestFixture,
+             EnchantDictionarySuggest_EachSuggestionAllocatedOnce)
+{
+    enchant_dict_set_suggest_cache_size(_dict, 0, 0);
+    // The first calls set up what later ones use
+    CountSuggestAllocations(_dict, returnEight);
+    enchant_dict_is_removed(_dict, "aelo", -1);
+
+    // Besides the provider's copy, each suggestion is only normalized
+    // and looked up in the exclude list
+    nAllocations = 0;
+    countAllocations = true;
+    char* normalized = g_utf8_normalize("aelo", -1, G_NORMALIZE_NFD);
+    enchant_dict_is_removed(_dict, "aelo", -1);
+    countAllocations = false;
+    g_free(normalized);
+    int nPerSuggestion = 1 + nAllocations;
+
+    int nFour = CountSuggestAllocations(_dict, returnFour);
+    int nEight = CountSuggestAllocations(_dict, returnEight);
+    CHECK_EQUAL(4 * nPerSuggestion, nEight - nFour);
+}
+#endif
+
+TEST_FIXTURE(EnchantDictionarySuggest_TestFixture,
+             EnchantDictionarySuggest_DuplicatesInDictionary_ReturnedOnce)
+{
+    suggestBehavior = returnFianceNfcAndNfdTwice;
+
+    size_t cSuggestions;
+    _suggestions = enchant_dict_suggest(_dict, "fiance", -1, &cSuggestions);
+    CHECK(_suggestions);
+
+    CHECK_EQUAL(2, cSuggestions);
+    CHECK_EQUAL(Convert(L"fianc\xe9"), _suggestions[0]);
+    CHECK_EQUAL("fiance", _suggestions[1]);
+}
+
 TEST_FIXTURE(EnchantDictionarySuggestNotImplemented_TestFixture,
              EnchantDictionarySuggest_WordInDictionaryAndExclude_NotInSuggestions)
 {
@@ -106,4 +106,10 @@ configure_enchant_provider(EnchantProvider * me, const char *dir_name)
     }
 }
 
+int
+enchant_provider_abi_version(void)
+{
+    return ENCHANT_PROVIDER_ABI_VERSION;
+}
+
 }
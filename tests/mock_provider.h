@@ -12,6 +12,7 @@ extern "C" {
 void set_configure(ConfigureHook hook);
 EnchantProvider * init_enchant_provider(void);
 void configure_enchant_provider(EnchantProvider * me, const char *dir_name);
+int enchant_provider_abi_version(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,239 @@
+/* Copyright (c) 2026 Enchant contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Microbenchmark for personal word list lookups.
+ *
+ * Not run by "make check"; build it with "make enchant_pwl_benchmark" and run
+ *
+ *     ./enchant_pwl_benchmark [number-of-words]
+ *
+ * It fills an in-memory PWL with pseudo-random words, then times checks and
+ * suggestions for misspellings of them, reporting the mean time per call and,
+ * for suggestions, the mean number of trie nodes or indexed words visited,
+ * and for checks, how often the membership filter answered a lookup.
+ * Suggestions are timed both by searching the trie and with the deletion
+ * index, and the same words are then timed opened read-only from a file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "pwl.h"
+
+#define N_QUERIES 500
+
+static guint32 seed = 12345;
+
+static guint32 next_random(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7fff;
+}
+
+static char* random_word(size_t min_len, size_t max_len)
+{
+	static const char* const letters[] = {
+		"a", "b", "c", "d", "e", "f", "g", "h", "i", "k", "l", "m",
+		"n", "o", "p", "r", "s", "t", "u", "w", "\xc3\xa9", "\xc3\xbc"
+	};
+	size_t len = min_len + next_random() % (max_len - min_len + 1);
+	GString* word = g_string_new(NULL);
+	for (size_t i = 0; i < len; i++)
+		g_string_append(word, letters[next_random() % G_N_ELEMENTS(letters)]);
+	/* Capitalize a quarter of the words, like names */
+	if (next_random() % 4 == 0)
+		word->str[0] = g_ascii_toupper(word->str[0]);
+	return g_string_free(word, FALSE);
+}
+
+/* Replace one ASCII letter and, if swap, swap another pair, so the
+ * misspelling is up to one or two edits away from the original */
+static char* misspell(const char* word, gboolean swap)
+{
+	char* typo = g_strdup(word);
+	size_t len = strlen(typo);
+	size_t i = next_random() % len;
+	if ((typo[i] & 0x80) == 0)
+		typo[i] = 'z';
+	i = next_random() % len;
+	if (swap && i + 1 < len && (typo[i] & 0x80) == 0 && (typo[i + 1] & 0x80) == 0) {
+		char c = typo[i];
+		typo[i] = typo[i + 1];
+		typo[i + 1] = c;
+	}
+	return typo;
+}
+
+static void report(const char* what, gint64 start, int calls)
+{
+	gint64 elapsed = g_get_monotonic_time() - start;
+	printf("%-36s %10.2f us/call\n", what, (double)elapsed / calls);
+}
+
+static void report_filter(EnchantPWL* pwl)
+{
+	size_t n_lookups, n_rejected, n_false_positives;
+	enchant_pwl_get_filter_stats(pwl, &n_lookups, &n_rejected, &n_false_positives);
+	printf("%-36s %10.1f %% of %zu lookups rejected, %.2f %% of misses let through\n", "filter",
+	       n_lookups ? 100.0 * n_rejected / n_lookups : 0.0, n_lookups,
+	       n_rejected + n_false_positives ?
+	       100.0 * n_false_positives / (n_rejected + n_false_positives) : 0.0);
+}
+
+static void bench_suggest(EnchantPWL* pwl, const char* what, char** queries,
+			  char** provider_suggs)
+{
+	size_t visited = enchant_pwl_get_visited_nodes(pwl);
+	gint64 start = g_get_monotonic_time();
+	for (int i = 0; i < N_QUERIES; i++) {
+		size_t n_suggs;
+		char** suggs = enchant_pwl_suggest(pwl, queries[i], strlen(queries[i]),
+						   provider_suggs, &n_suggs);
+		g_strfreev(suggs);
+	}
+	report(what, start, N_QUERIES);
+	printf("%-36s %10.0f nodes/call\n", "",
+	       (double)(enchant_pwl_get_visited_nodes(pwl) - visited) / N_QUERIES);
+}
+
+int main(int argc, char** argv)
+{
+	int n_words = argc > 1 ? atoi(argv[1]) : 20000;
+	if (n_words <= 0) {
+		fprintf(stderr, "usage: %s [number-of-words]\n", argv[0]);
+		return 1;
+	}
+
+	EnchantPWL* pwl = enchant_pwl_init();
+	char** words = g_new0(char*, n_words + 1);
+	gint64 start = g_get_monotonic_time();
+	for (int i = 0; i < n_words; i++) {
+		/* A few long words exercise the path for words over 64 characters */
+		words[i] = i % 100 == 0 ? random_word(65, 90) : random_word(3, 12);
+		enchant_pwl_add(pwl, words[i], strlen(words[i]));
+	}
+	report("add", start, n_words);
+
+	char** queries = g_new0(char*, N_QUERIES + 1);
+	char** near_queries = g_new0(char*, N_QUERIES + 1);
+	char** long_queries = g_new0(char*, N_QUERIES + 1);
+	for (int i = 0; i < N_QUERIES; i++) {
+		queries[i] = misspell(words[next_random() % n_words], TRUE);
+		near_queries[i] = misspell(words[next_random() % n_words], FALSE);
+		long_queries[i] = misspell(words[(next_random() % ((n_words + 99) / 100)) * 100], TRUE);
+	}
+
+	start = g_get_monotonic_time();
+	for (int i = 0; i < N_QUERIES; i++)
+		enchant_pwl_check(pwl, queries[i], strlen(queries[i]));
+	report("check (misspelt)", start, N_QUERIES);
+
+	start = g_get_monotonic_time();
+	for (int i = 0; i < N_QUERIES; i++) {
+		const char* word = words[next_random() % n_words];
+		enchant_pwl_check(pwl, word, strlen(word));
+	}
+	report("check (listed)", start, N_QUERIES);
+
+	/* Capitalized words are looked up in lower case too */
+	char** title_queries = g_new0(char*, N_QUERIES + 1);
+	for (int i = 0; i < N_QUERIES; i++) {
+		title_queries[i] = g_strdup(words[next_random() % n_words]);
+		title_queries[i][0] = g_ascii_toupper(title_queries[i][0]);
+	}
+	start = g_get_monotonic_time();
+	for (int i = 0; i < N_QUERIES; i++)
+		enchant_pwl_check(pwl, title_queries[i], strlen(title_queries[i]));
+	report("check (capitalized)", start, N_QUERIES);
+	g_strfreev(title_queries);
+	report_filter(pwl);
+
+	/* Stand-ins for a provider's suggestions, which bound the search */
+	char* provider_suggs[] = { "abcdefg", "hiklmnop", "rstuw", "abcabcabcabc", NULL };
+
+	static const struct {
+		EnchantPWLSuggestIndex mode;
+		const char* name;
+	} engines[] = {
+		{ ENCHANT_PWL_SUGGEST_INDEX_NEVER, "trie" },
+		{ ENCHANT_PWL_SUGGEST_INDEX_ALWAYS, "deletion index" }
+	};
+	for (size_t i = 0; i < G_N_ELEMENTS(engines); i++) {
+		printf("%s:\n", engines[i].name);
+		enchant_pwl_set_suggest_index(pwl, engines[i].mode);
+
+		/* The first suggestion builds the index */
+		start = g_get_monotonic_time();
+		size_t n_suggs;
+		g_strfreev(enchant_pwl_suggest(pwl, queries[0], strlen(queries[0]), NULL, &n_suggs));
+		report("first suggest", start, 1);
+
+		bench_suggest(pwl, "suggest", queries, NULL);
+		bench_suggest(pwl, "suggest (one edit away)", near_queries, NULL);
+		bench_suggest(pwl, "suggest (long words)", long_queries, NULL);
+		bench_suggest(pwl, "suggest (with provider suggestions)", queries, provider_suggs);
+	}
+
+	/* A read-only list keeps its words in a minimized trie */
+	char* filename = NULL;
+	int fd = g_file_open_tmp("enchant_pwl_benchmark-XXXXXX", &filename, NULL);
+	if (fd != -1) {
+		FILE* f = fdopen(fd, "w");
+		for (int i = 0; i < n_words; i++)
+			fprintf(f, "%s\n", words[i]);
+		fclose(f);
+
+		printf("read-only:\n");
+		start = g_get_monotonic_time();
+		EnchantPWL* read_only = enchant_pwl_init_with_file_read_only(filename);
+		/* The file is read when first used */
+		enchant_pwl_check(read_only, words[0], strlen(words[0]));
+		report("load", start, 1);
+		enchant_pwl_set_suggest_index(read_only, ENCHANT_PWL_SUGGEST_INDEX_NEVER);
+
+		start = g_get_monotonic_time();
+		for (int i = 0; i < N_QUERIES; i++)
+			enchant_pwl_check(read_only, queries[i], strlen(queries[i]));
+		report("check (misspelt)", start, N_QUERIES);
+		report_filter(read_only);
+
+		start = g_get_monotonic_time();
+		size_t n_suggs;
+		g_strfreev(enchant_pwl_suggest(read_only, queries[0], strlen(queries[0]), NULL, &n_suggs));
+		report("first suggest", start, 1);
+		bench_suggest(read_only, "suggest", queries, NULL);
+		bench_suggest(read_only, "suggest (one edit away)", near_queries, NULL);
+
+		enchant_pwl_free(read_only);
+		g_unlink(filename);
+		g_free(filename);
+	}
+
+	g_strfreev(long_queries);
+	g_strfreev(near_queries);
+	g_strfreev(queries);
+	g_strfreev(words);
+	enchant_pwl_free(pwl);
+	return 0;
+}
@@ -22,10 +22,13 @@
 #include <unistd.h>
 #include <UnitTest++/UnitTest++.h>
 #include <stdio.h>
+#include <string.h>
+#include <locale.h>
 #include <enchant.h>
 #include <enchant-provider.h>
 
 #include "EnchantDictionaryTestFixture.h"
+#include "pwl.h"
 
 #include <algorithm>
 
@@ -350,11 +353,11 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
-// Too long lines ignored
+// Long lines
 TEST_FIXTURE(EnchantPwl_TestFixture, 
-             IsWordInDictionary_DictionaryHasSuperLongLine_DoesNotReadLine)
+             IsWordInDictionary_DictionaryHasSuperLongLine_ReadsLine)
 {
-  const size_t lineLen = BUFSIZ + 1; // enchant ignores PWL lines longer than BUFSIZ
+  const size_t lineLen = BUFSIZ + 1; // longer than enchant used to read
 
   std::vector<std::string> sWords;
   sWords.push_back("cat");
@@ -371,7 +374,7 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
     CHECK( IsWordInDictionary(*itWord) );
   }
 
-  CHECK(!IsWordInDictionary(*superlong) );
+  CHECK( IsWordInDictionary(*superlong) );
   for(size_t i=0; i != lineLen; ++i)
   {
       CHECK(!IsWordInDictionary(std::string(i, 'c')) );
@@ -424,6 +427,26 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
   CHECK( IsWordInDictionary(Convert(L"fiance\x301")) ); //NFD
 }
 
+TEST_FIXTURE(EnchantPwl_TestFixture,
+             IsWordInDictionary_MarksInOtherOrder_Successful)
+{
+  AddWordToDictionary(Convert(L"pho\x323\x302")); // u0323 = Combining dot below, u0302 = Combining circumflex
+
+  CHECK( IsWordInDictionary(Convert(L"pho\x302\x323")) );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture,
+             IsWordInDictionary_AddedLongWordCheckedCapitalized_Successful)
+{
+  std::string longWord(200, 'a');
+  AddWordToDictionary(longWord);
+
+  std::string capitalizedWord(longWord);
+  capitalizedWord[0] = 'A';
+  CHECK( IsWordInDictionary(capitalizedWord) );
+  CHECK( IsWordInDictionary(std::string(200, 'A')) );
+}
+
 TEST_FIXTURE(EnchantPwl_TestFixture, 
              Suggest_DictionaryHasComposed_ReturnsComposed)
 {
@@ -730,6 +753,44 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
   CHECK_ARRAY_EQUAL(expected, suggestions, expected.size());
 }
 
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             GetSuggestions_AddedTwoCasesOneRemoved_OtherSuggested)
+{
+  AddWordToDictionary("Rice");
+  AddWordToDictionary("rice");
+  CHECK_EQUAL(2, GetSuggestionsFromWord("ric").size());
+
+  RemoveWordFromDictionary("Rice");
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("ric");
+
+  std::vector<std::string> expected;
+  expected.push_back("rice");
+  CHECK_EQUAL(expected.size(), suggestions.size());
+  CHECK_ARRAY_EQUAL(expected, suggestions, expected.size());
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             GetSuggestions_TurkishLocale_FoldedAsTrie)
+{
+  AddWordToDictionary("Ian");
+  AddWordToDictionary("Jam");
+
+  // lowering "I" gives a dotless i in Turkish, but the words are folded without regard to the locale
+  std::string origLocale(setlocale (LC_ALL, NULL));
+  if(setlocale (LC_ALL, "tr_TR.UTF-8") == NULL)
+    return;
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("Iam");
+  setlocale (LC_ALL, origLocale.c_str());
+
+  std::sort(suggestions.begin(), suggestions.end());
+  std::vector<std::string> expected;
+  expected.push_back("Ian");
+  expected.push_back("Jam");
+  CHECK_EQUAL(expected.size(), suggestions.size());
+  CHECK_ARRAY_EQUAL(expected, suggestions, std::min(expected.size(), suggestions.size()));
+}
+
 
 
 
@@ -1242,6 +1303,163 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
   CHECK(!IsWordInDictionary(*removed) );
 }
 
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlRemove_ItemRemovedThenAddedBack_ItemPersisted)
+{
+  AddWordToDictionary("cat");
+  AddWordToDictionary("hello");
+  RemoveWordFromDictionary("hello");
+  AddWordToDictionary("hello");
+
+  ReloadTestDictionary(); // to see what actually persisted
+
+  CHECK( IsWordInDictionary("cat") );
+  CHECK( IsWordInDictionary("hello") );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlRemove_SmallFile_FileCompactedAtOnce)
+{
+  AddWordToDictionary("cat");
+  AddWordToDictionary("hello");
+  AddWordToDictionary("hat");
+  RemoveWordFromDictionary("hello");
+
+  // older versions of enchant, which skip the removal, see the file too
+  char *contents = NULL;
+  CHECK( g_file_get_contents(GetPersonalDictFileName().c_str(), &contents, NULL, NULL) );
+  if(contents)
+    CHECK( strstr(contents, "hello") == NULL );
+  g_free(contents);
+
+  ReloadTestDictionary(); // to see what actually persisted
+
+  CHECK( IsWordInDictionary("cat") );
+  CHECK(!IsWordInDictionary("hello") );
+  CHECK( IsWordInDictionary("hat") );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlRemove_LargeFile_FileOnlyAppendedTo)
+{
+  std::vector<std::string> sWords;
+  for(int i = 0; i < 20000; i++)
+  {
+    std::string word("z");
+    for(int n = i; n > 0; n /= 26)
+      word += (char)('a' + n % 26);
+    sWords.push_back(word);
+  }
+  sWords.push_back("cat");
+  sWords.push_back("hello");
+  sWords.push_back("hat");
+  ExternalAddWordsToDictionary(sWords);
+
+  char *before = NULL, *after = NULL;
+  gsize beforeLength = 0, afterLength = 0;
+  CHECK( g_file_get_contents(GetPersonalDictFileName().c_str(), &before, &beforeLength, NULL) );
+  RemoveWordFromDictionary("hello");
+  CHECK( g_file_get_contents(GetPersonalDictFileName().c_str(), &after, &afterLength, NULL) );
+
+  CHECK( afterLength > beforeLength );
+  CHECK( before && after && memcmp(before, after, beforeLength) == 0 );
+  g_free(before);
+  g_free(after);
+
+  ReloadTestDictionary(); // to see what actually persisted
+
+  CHECK( IsWordInDictionary("cat") );
+  CHECK(!IsWordInDictionary("hello") );
+  CHECK( IsWordInDictionary("hat") );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlRemove_ManyItemsRemoved_FileCompacted)
+{
+  AddWordToDictionary("cat");
+
+  std::vector<std::string> sWords;
+  for(int i = 0; i < 200; i++)
+  {
+    std::string word("z");
+    for(int n = i; n > 0; n /= 26)
+      word += (char)('a' + n % 26);
+    sWords.push_back(word);
+    AddWordToDictionary(word);
+    RemoveWordFromDictionary(word);
+  }
+
+  // the removals took 400 lines, but the file is rewritten as it is small
+  char *contents = NULL;
+  CHECK( g_file_get_contents(GetPersonalDictFileName().c_str(), &contents, NULL, NULL) );
+  if(contents)
+    CHECK( std::count(contents, contents + strlen(contents), '\n') < 200 );
+  g_free(contents);
+
+  ReloadTestDictionary(); // to see what actually persisted
+
+  CHECK( IsWordInDictionary("cat") );
+  for(std::vector<std::string>::const_iterator itWord = sWords.begin(); itWord != sWords.end(); ++itWord){
+    CHECK(!IsWordInDictionary(*itWord) );
+  }
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlRemove_CommentsLikeRemovals_WordsKept)
+{
+  std::vector<std::string> sWords;
+  sWords.push_back("cat");
+  sWords.push_back("#-cat");
+  sWords.push_back("#------");
+  sWords.push_back("#-*- coding: utf-8 -*-");
+  sWords.push_back("hello");
+
+  ExternalAddWordsToDictionary(sWords);
+
+  CHECK( IsWordInDictionary("cat") );
+  CHECK( IsWordInDictionary("hello") );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlRemove_FileCompacted_CommentsKept)
+{
+  std::vector<std::string> sComments;
+  sComments.push_back("#-cat");
+  sComments.push_back("#------");
+  sComments.push_back("#-*- coding: utf-8 -*-");
+  sComments.push_back("#enchant-remove:dog"); // removes nothing
+
+  std::vector<std::string> sWords;
+  sWords.push_back("cat");
+  sWords.insert(sWords.end(), sComments.begin(), sComments.end());
+  ExternalAddWordsToDictionary(sWords);
+
+  for(int i = 0; i < 200; i++)
+  {
+    std::string word("z");
+    for(int n = i; n > 0; n /= 26)
+      word += (char)('a' + n % 26);
+    AddWordToDictionary(word);
+    RemoveWordFromDictionary(word);
+  }
+
+  char *contents = NULL;
+  CHECK( g_file_get_contents(GetPersonalDictFileName().c_str(), &contents, NULL, NULL) );
+  if(contents)
+  {
+    CHECK( std::count(contents, contents + strlen(contents), '\n') < 200 );
+    for(std::vector<std::string>::const_iterator itComment = sComments.begin(); itComment != sComments.end(); ++itComment){
+      CHECK( strstr(contents, (*itComment + "\n").c_str()) != NULL );
+    }
+  }
+  g_free(contents);
+
+  ReloadTestDictionary(); // to see what actually persisted
+
+  CHECK( IsWordInDictionary("cat") );
+  CHECK(!IsWordInDictionary("dog") );
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Pwl Edit distance
 TEST_FIXTURE(EnchantPwl_TestFixture, 
@@ -1288,13 +1506,13 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
              PwlSuggest_HasProperSubset_SubstituteFirstChar_Insert2)
 {
   std::vector<std::string> sWords;
-  sWords.push_back("catch"); //3
+  sWords.push_back("catcher"); //3
 
   AddWordsToDictionary(sWords);
 
-  AddWordToDictionary("catchy"); //4
+  AddWordToDictionary("catchers"); //4
 
-  std::vector<std::string> suggestions = GetSuggestionsFromWord("tat");
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("tatch");
 
   CHECK_EQUAL(sWords.size(), suggestions.size());
 
@@ -1328,13 +1546,13 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
              PwlSuggest_HasProperSubset_Insert2)
 {
   std::vector<std::string> sWords;
-  sWords.push_back("tote"); //2
+  sWords.push_back("totem"); //2
 
   AddWordsToDictionary(sWords);
 
-  AddWordToDictionary("totems"); //4
+  AddWordToDictionary("totems"); //3
 
-  std::vector<std::string> suggestions = GetSuggestionsFromWord("to");
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("tot");
 
   CHECK_EQUAL(sWords.size(), suggestions.size());
 
@@ -1343,17 +1561,39 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
 
   CHECK_ARRAY_EQUAL(sWords, suggestions, std::min(sWords.size(), suggestions.size()));
 }
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlSuggest_ShortWord_NothingTwoEditsAway)
+{
+  AddWordToDictionary("tote"); //2
+  AddWordToDictionary("toad"); //2
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("to");
+  CHECK_EQUAL(0, suggestions.size());
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlSuggest_ShortWord_OneEditAwayFound)
+{
+  AddWordToDictionary("top"); //1
+  AddWordToDictionary("tote"); //2
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("to");
+  CHECK_EQUAL(1, suggestions.size());
+  if(suggestions.size() == 1)
+    CHECK_EQUAL("top", suggestions[0]);
+}
 TEST_FIXTURE(EnchantPwl_TestFixture, 
              PwlSuggest_HasProperSubset_Insert3)
 {
   std::vector<std::string> sWords;
-  sWords.push_back("catch"); //3
+  sWords.push_back("catchall"); //3
 
   AddWordsToDictionary(sWords);
 
-  AddWordToDictionary("catchy"); //4
+  AddWordToDictionary("catchalls"); //4
 
-  std::vector<std::string> suggestions = GetSuggestionsFromWord("ca");
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("catch");
 
   CHECK_EQUAL(sWords.size(), suggestions.size());
 
@@ -1545,11 +1785,11 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
              PwlSuggest_Transpose1Insert2)
 {
   std::vector<std::string> sWords;
-  sWords.push_back("catch"); //3
+  sWords.push_back("caterer"); //3
 
   AddWordsToDictionary(sWords);
 
-  std::vector<std::string> suggestions = GetSuggestionsFromWord("act");
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("acter");
 
   CHECK_EQUAL(sWords.size(), suggestions.size());
 
@@ -1577,3 +1817,548 @@ TEST_FIXTURE(EnchantPwl_TestFixture,
   CHECK_ARRAY_EQUAL(sWords, suggestions, std::min(sWords.size(), suggestions.size()));
 }
 
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlSuggest_TransposeFirstChars_FoundAlongsideSubstitute)
+{
+  std::vector<std::string> sWords;
+  sWords.push_back("act"); //1
+  sWords.push_back("hat"); //1
+
+  AddWordsToDictionary(sWords);
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("cat");
+
+  CHECK_EQUAL(sWords.size(), suggestions.size());
+
+  std::sort(sWords.begin(), sWords.end());
+  std::sort(suggestions.begin(), suggestions.end());
+
+  CHECK_ARRAY_EQUAL(sWords, suggestions, std::min(sWords.size(), suggestions.size()));
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             PwlSuggest_Transpose1Substitute1_OnlyClosestReturned)
+{
+  std::vector<std::string> sWords;
+  sWords.push_back("ear"); //2
+
+  AddWordsToDictionary(sWords);
+
+  AddWordToDictionary("car"); //3
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("aec");
+
+  CHECK_EQUAL(sWords.size(), suggestions.size());
+
+  std::sort(sWords.begin(), sWords.end());
+  std::sort(suggestions.begin(), suggestions.end());
+
+  CHECK_ARRAY_EQUAL(sWords, suggestions, std::min(sWords.size(), suggestions.size()));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Compiled index
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             IsWordInDictionary_ReloadedFromIndex_Successful)
+{
+  std::vector<std::string> sWords;
+  sWords.push_back("cat");
+  sWords.push_back("hat");
+  sWords.push_back("that");
+  ExternalAddWordsToDictionary(sWords);
+
+  ReloadTestDictionary();
+  CHECK( IsWordInDictionary("cat") ); // parses the word list and writes the index
+  CHECK(g_file_test((GetPersonalDictFileName() + ".idx").c_str(), G_FILE_TEST_EXISTS));
+
+  ReloadTestDictionary(); // reads the index when first used
+
+  for(std::vector<std::string>::const_iterator itWord = sWords.begin(); itWord != sWords.end(); ++itWord){
+    CHECK( IsWordInDictionary(*itWord) );
+  }
+  CHECK(!IsWordInDictionary("bat") );
+
+  AddWordToDictionary("bat");
+  RemoveWordFromDictionary("hat");
+  CHECK( IsWordInDictionary("bat") );
+  CHECK(!IsWordInDictionary("hat") );
+  CHECK( IsWordInDictionary("that") );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             GetSuggestionsFromWord_ReloadedFromIndex_ReturnsWordAsAdded)
+{
+  ExternalAddWordToDictionary("Zo\xc3\xab"); // precomposed, stored decomposed in the trie
+
+  ReloadTestDictionary();
+  CHECK( IsWordInDictionary("Zo\xc3\xab") ); // writes the index
+  ReloadTestDictionary();
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("Zoe");
+  CHECK_EQUAL(1, suggestions.size());
+  if(suggestions.size() == 1)
+    CHECK_EQUAL("Zo\xc3\xab", suggestions[0]);
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             IsWordInDictionary_WordListChangedAfterIndex_IndexIgnored)
+{
+  ExternalAddWordToDictionary("cat");
+  ReloadTestDictionary();
+  CHECK( IsWordInDictionary("cat") ); // writes the index
+
+  ExternalAddWordToDictionary("hat");
+  ReloadTestDictionary();
+
+  CHECK( IsWordInDictionary("cat") );
+  CHECK( IsWordInDictionary("hat") );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             IsWordInDictionary_BrokerPwl_NoIndexWritten)
+{
+  FILE * f = g_fopen(_pwlFileName.c_str(), "w");
+  CHECK(f);
+  if(f)
+  {
+    fputs("cat\nhat\n", f);
+    fclose(f);
+  }
+
+  CHECK_EQUAL(0, enchant_dict_check(_pwl, "cat", -1)); // parses the word list
+  CHECK(!g_file_test((_pwlFileName + ".idx").c_str(), G_FILE_TEST_EXISTS));
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             IsWordInDictionary_WordListRewrittenInPlaceSameSize_IndexIgnored)
+{
+  ExternalAddWordToDictionary("cat");
+  ReloadTestDictionary();
+  CHECK( IsWordInDictionary("cat") ); // writes the index
+
+  // replace the word without changing the size of the file or the second it was changed in
+  std::string fileName = GetPersonalDictFileName();
+  struct stat before;
+  CHECK_EQUAL(0, stat(fileName.c_str(), &before));
+  FILE * f = g_fopen(fileName.c_str(), "r+b");
+  CHECK(f);
+  if(f)
+  {
+    fputs("hat", f);
+    fclose(f);
+  }
+  struct timespec times[2] = { before.st_atim, before.st_mtim };
+  times[1].tv_nsec = (times[1].tv_nsec + 1) % 1000000000;
+  CHECK_EQUAL(0, utimensat(AT_FDCWD, fileName.c_str(), times, 0));
+  ReloadTestDictionary();
+
+  CHECK( IsWordInDictionary("hat") );
+  CHECK(!IsWordInDictionary("cat") );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             IsWordInDictionary_IndexCorrupt_WordListParsed)
+{
+  std::vector<std::string> sWords;
+  for(char c = 'a'; c <= 'z'; ++c){
+    sWords.push_back(std::string(1, c) + "at");
+    sWords.push_back(std::string(1, c) + "og");
+  }
+  ExternalAddWordsToDictionary(sWords);
+  ReloadTestDictionary();
+  CHECK( IsWordInDictionary("cat") ); // writes the index
+
+  // damage the trie, leaving the header and the end of the strings be
+  std::string indexFileName = GetPersonalDictFileName() + ".idx";
+  FILE * f = g_fopen(indexFileName.c_str(), "r+b");
+  CHECK(f);
+  if(f)
+  {
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    CHECK(length > 512);
+    fseek(f, 256, SEEK_SET);
+    for(long i = 256; i < length - 1; ++i)
+      fputc(0xff, f);
+    fclose(f);
+  }
+  ReloadTestDictionary();
+
+  for(std::vector<std::string>::const_iterator itWord = sWords.begin(); itWord != sWords.end(); ++itWord){
+    CHECK( IsWordInDictionary(*itWord) );
+  }
+  CHECK(!IsWordInDictionary("cot") );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             IsWordInDictionary_IndexOfOtherByteOrder_IndexRebuilt)
+{
+  std::vector<std::string> sWords;
+  sWords.push_back("cat");
+  sWords.push_back("hat");
+  ExternalAddWordsToDictionary(sWords);
+  ReloadTestDictionary();
+  CHECK( IsWordInDictionary("cat") ); // writes the index
+
+  // swap the bytes of the byte order mark, which follows the magic and version
+  std::string indexFileName = GetPersonalDictFileName() + ".idx";
+  unsigned char mark[4] = { 0 }, swapped[4] = { 0 }, rebuilt[4] = { 0 };
+  FILE * f = g_fopen(indexFileName.c_str(), "r+b");
+  CHECK(f);
+  if(f)
+  {
+    fseek(f, 12, SEEK_SET);
+    CHECK_EQUAL(4u, fread(mark, 1, 4, f));
+    for(int i = 0; i < 4; ++i)
+      swapped[i] = mark[3 - i];
+    fseek(f, 12, SEEK_SET);
+    fwrite(swapped, 1, 4, f);
+    fclose(f);
+  }
+  ReloadTestDictionary();
+
+  for(std::vector<std::string>::const_iterator itWord = sWords.begin(); itWord != sWords.end(); ++itWord){
+    CHECK( IsWordInDictionary(*itWord) );
+  }
+
+  // the word list was parsed again, and the index written anew
+  f = g_fopen(indexFileName.c_str(), "rb");
+  CHECK(f);
+  if(f)
+  {
+    fseek(f, 12, SEEK_SET);
+    CHECK_EQUAL(4u, fread(rebuilt, 1, 4, f));
+    fclose(f);
+  }
+  CHECK_ARRAY_EQUAL(mark, rebuilt, 4);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Incremental reload
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             IsWordInDictionary_LinesAppendedExternally_AllWordsFound)
+{
+  AddWordToDictionary("cat");
+  CHECK( IsWordInDictionary("cat") );
+
+  FILE * f = g_fopen(GetPersonalDictFileName().c_str(), "a");
+  if(f)
+  {
+    fputs("hat\nthat\n", f);
+    fclose(f);
+  }
+
+  CHECK( IsWordInDictionary("cat") );
+  CHECK( IsWordInDictionary("hat") );
+  CHECK( IsWordInDictionary("that") );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             IsWordInDictionary_FileShrunkExternally_RemovedWordsNotFound)
+{
+  AddWordToDictionary("cat");
+  AddWordToDictionary("hat");
+  CHECK( IsWordInDictionary("hat") );
+
+  sleep(1); // FAT systems have a 2 second resolution
+               // NTFS is appreciably faster but no specs on what it is exactly
+               // c runtime library's time_t has a 1 second resolution
+  FILE * f = g_fopen(GetPersonalDictFileName().c_str(), "w");
+  if(f)
+  {
+    fputs("cat\n", f);
+    fclose(f);
+  }
+
+  CHECK( IsWordInDictionary("cat") );
+  CHECK(!IsWordInDictionary("hat") );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Deletion index
+
+// Enough words for suggestions to come from the deletion index, none of
+// them within three edits of the words the tests look for
+static std::vector<std::string> LargeWordList()
+{
+  const char letters[] = "jkqvxz";
+  std::vector<std::string> sWords;
+  for(int i = 0; i < 50000; i++)
+  {
+    std::string word;
+    for(int n = i, j = 0; j < 7; n /= 6, j++)
+      word += letters[n % 6];
+    sWords.push_back(word);
+  }
+  return sWords;
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             IsWordInDictionary_LargeListHasInvalidUtf8Line_ReadsOtherLines)
+{
+  std::vector<std::string> sWords = LargeWordList();
+  std::vector<std::string> sAllWords(sWords);
+  sAllWords.insert(sAllWords.begin() + sAllWords.size() / 2, "\xa5\xf1\x08");
+  sAllWords.push_back(std::string(BUFSIZ * 4, 'j'));
+  ExternalAddWordsToDictionary(sAllWords);
+  ReloadTestDictionary();
+
+  for(std::vector<std::string>::const_iterator itWord = sWords.begin(); itWord != sWords.end(); ++itWord){
+    CHECK( IsWordInDictionary(*itWord) );
+  }
+  CHECK( IsWordInDictionary(sAllWords.back()) );
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             GetSuggestionsFromWord_LargeList_ReturnsOnlyClosest)
+{
+  std::vector<std::string> sWords;
+  sWords.push_back("cat");
+  sWords.push_back("hat");
+  sWords.push_back("that");
+  sWords.push_back("bat");
+  sWords.push_back("tot");
+
+  std::vector<std::string> sAllWords = LargeWordList();
+  sAllWords.insert(sAllWords.end(), sWords.begin(), sWords.end());
+  sAllWords.push_back("spat");
+  sAllWords.push_back("tater");
+  sAllWords.push_back("gnat");
+  ExternalAddWordsToDictionary(sAllWords);
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("tat");
+  CHECK_EQUAL(sWords.size(), suggestions.size());
+
+  std::sort(sWords.begin(), sWords.end());
+  std::sort(suggestions.begin(), suggestions.end());
+
+  CHECK_ARRAY_EQUAL(sWords, suggestions, std::min(sWords.size(), suggestions.size()));
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             GetSuggestionsFromWord_LargeListThreeEditsAway_Found)
+{
+  std::vector<std::string> sAllWords = LargeWordList();
+  sAllWords.push_back("catchier"); //3
+  sAllWords.push_back("catchiness"); //5
+  ExternalAddWordsToDictionary(sAllWords);
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("catch");
+  CHECK_EQUAL(1, suggestions.size());
+  if(suggestions.size() == 1)
+    CHECK_EQUAL("catchier", suggestions[0]);
+}
+
+TEST_FIXTURE(EnchantPwl_TestFixture, 
+             GetSuggestionsFromWord_LargeListChanged_ChangesSeen)
+{
+  std::vector<std::string> sAllWords = LargeWordList();
+  sAllWords.push_back("cat");
+  sAllWords.push_back("hat");
+  ExternalAddWordsToDictionary(sAllWords);
+  CHECK_EQUAL(2, GetSuggestionsFromWord("tat").size());
+
+  AddWordToDictionary("tart");
+  RemoveWordFromDictionary("hat");
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("tat");
+  std::sort(suggestions.begin(), suggestions.end());
+  CHECK_EQUAL(2, suggestions.size());
+  if(suggestions.size() == 2)
+  {
+    CHECK_EQUAL("cat", suggestions[0]);
+    CHECK_EQUAL("tart", suggestions[1]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Read-only word list
+struct EnchantPwlReadOnly_TestFixture : EnchantTestFixture
+{
+    std::string _fileName;
+    EnchantPWL* _pwl;
+
+    //Setup
+    EnchantPwlReadOnly_TestFixture():
+        _fileName(AddToPath(GetTempUserEnchantDir(), "terms.dic")), _pwl(NULL)
+    { }
+
+    //Teardown
+    ~EnchantPwlReadOnly_TestFixture()
+    {
+        if(_pwl)
+            enchant_pwl_free(_pwl);
+    }
+
+    void OpenReadOnly(const std::vector<std::string>& sWords)
+    {
+        FILE * f = g_fopen(_fileName.c_str(), "w");
+        if(f)
+        {
+            for(std::vector<std::string>::const_iterator itWord = sWords.begin();
+                itWord != sWords.end(); ++itWord)
+                fprintf(f, "%s\n", itWord->c_str());
+            fclose(f);
+        }
+        _pwl = enchant_pwl_init_with_file_read_only(_fileName.c_str());
+    }
+
+    bool IsWordInList(const std::string& word)
+    {
+        return enchant_pwl_check(_pwl, word.c_str(), word.size()) == 0;
+    }
+
+    std::vector<std::string> GetSuggestionsFromWord(const std::string& word)
+    {
+        std::vector<std::string> result;
+        size_t cSuggestions;
+        char** suggestions = enchant_pwl_suggest(_pwl, word.c_str(), word.size(), NULL, &cSuggestions);
+        if(suggestions)
+            result.insert(result.begin(), suggestions, suggestions + cSuggestions);
+        g_strfreev(suggestions);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::vector<std::string> WordsSharingEndings()
+    {
+        std::vector<std::string> sWords;
+        sWords.push_back("talk");
+        sWords.push_back("talked");
+        sWords.push_back("talking");
+        sWords.push_back("talks");
+        sWords.push_back("walk");
+        sWords.push_back("walked");
+        sWords.push_back("walking");
+        return sWords;
+    }
+};
+
+TEST_FIXTURE(EnchantPwlReadOnly_TestFixture,
+             IsWordInList_ReadOnlyWordsSharingEndings_OnlyWordsFound)
+{
+  std::vector<std::string> sWords = WordsSharingEndings();
+  OpenReadOnly(sWords);
+  CHECK(_pwl);
+
+  for(std::vector<std::string>::const_iterator itWord = sWords.begin(); itWord != sWords.end(); ++itWord){
+    CHECK( IsWordInList(*itWord) );
+  }
+  CHECK( IsWordInList("Walking") );
+  CHECK( IsWordInList("TALKED") );
+  CHECK(!IsWordInList("walks") );
+  CHECK(!IsWordInList("wal") );
+  CHECK(!IsWordInList("talkeds") );
+}
+
+TEST_FIXTURE(EnchantPwlReadOnly_TestFixture,
+             IsWordInList_ReadOnlyHasRemovedWords_RemovedWordsNotFound)
+{
+  std::vector<std::string> sWords = WordsSharingEndings();
+  sWords.push_back("#enchant-remove:talked");
+  sWords.push_back("#enchant-remove:walking");
+  sWords.push_back("walking");
+  OpenReadOnly(sWords);
+
+  CHECK( IsWordInList("talk") );
+  CHECK(!IsWordInList("talked") );
+  CHECK( IsWordInList("walking") );
+}
+
+TEST_FIXTURE(EnchantPwlReadOnly_TestFixture,
+             GetSuggestionsFromWord_ReadOnly_Found)
+{
+  OpenReadOnly(WordsSharingEndings());
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("wakled");
+  CHECK_EQUAL(1, suggestions.size());
+  if(suggestions.size() == 1)
+    CHECK_EQUAL("walked", suggestions[0]);
+
+  suggestions = GetSuggestionsFromWord("Talkin");
+  CHECK_EQUAL(1, suggestions.size());
+  if(suggestions.size() == 1)
+    CHECK_EQUAL("Talking", suggestions[0]);
+}
+
+TEST_FIXTURE(EnchantPwlReadOnly_TestFixture,
+             GetSuggestionsFromWord_ReadOnlyHasComposed_ReturnsComposed)
+{
+  std::vector<std::string> sWords;
+  sWords.push_back(Convert(L"fianc\xe9")); // u00e9 = Latin small letter e with acute
+  sWords.push_back(Convert(L"Fianc\xe9"));
+  OpenReadOnly(sWords);
+
+  CHECK( IsWordInList(Convert(L"fiance\x301")) ); // u0301 = Combining acute accent
+
+  std::vector<std::string> suggestions = GetSuggestionsFromWord("fiance");
+  CHECK_EQUAL(sWords.size(), suggestions.size());
+  std::sort(sWords.begin(), sWords.end());
+  CHECK_ARRAY_EQUAL(sWords, suggestions, std::min(sWords.size(), suggestions.size()));
+}
+
+TEST_FIXTURE(EnchantPwlReadOnly_TestFixture,
+             AddRemove_ReadOnly_OnlyInMemory)
+{
+  OpenReadOnly(WordsSharingEndings());
+  std::string contents;
+  {
+    gchar* text = NULL;
+    CHECK( g_file_get_contents(_fileName.c_str(), &text, NULL, NULL) );
+    contents = text ? text : "";
+    g_free(text);
+  }
+
+  enchant_pwl_add(_pwl, "walks", 5);
+  enchant_pwl_remove(_pwl, "talk", 4);
+
+  CHECK( IsWordInList("walks") );
+  CHECK(!IsWordInList("talk") );
+  CHECK( IsWordInList("talks") );
+  CHECK( IsWordInList("walk") );
+
+  gchar* text = NULL;
+  CHECK( g_file_get_contents(_fileName.c_str(), &text, NULL, NULL) );
+  CHECK_EQUAL(contents, std::string(text ? text : ""));
+  g_free(text);
+}
+
+TEST_FIXTURE(EnchantPwlReadOnly_TestFixture,
+             IsWordInList_NotInList_AnsweredByFilter)
+{
+  OpenReadOnly(WordsSharingEndings());
+
+  CHECK(!IsWordInList("zebra") );
+  CHECK(!IsWordInList("Quagga") );
+  CHECK(!IsWordInList("OKAPI") );
+  CHECK( IsWordInList("walked") );
+
+  size_t n_lookups = 0, n_rejected = 0, n_false_positives = 0;
+  enchant_pwl_get_filter_stats(_pwl, &n_lookups, &n_rejected, &n_false_positives);
+  CHECK(n_rejected > 0);
+  CHECK(n_rejected + n_false_positives < n_lookups);
+}
+
+TEST_FIXTURE(EnchantPwlReadOnly_TestFixture,
+             IsWordInList_ChangedAfterFilterBuilt_Found)
+{
+  OpenReadOnly(WordsSharingEndings());
+  CHECK(!IsWordInList("walks") );
+
+  enchant_pwl_add(_pwl, "walks", 5);
+  CHECK( IsWordInList("walks") );
+  CHECK( IsWordInList("Walks") );
+
+  enchant_pwl_remove(_pwl, "walks", 5);
+  CHECK(!IsWordInList("walks") );
+
+  for(int i = 0; i < 200; ++i)
+  {
+    std::string word = "walk" + std::string(1, (char)('a' + i % 26)) + std::string(1, (char)('a' + i / 26));
+    enchant_pwl_add(_pwl, word.c_str(), word.size());
+  }
+  CHECK( IsWordInList("walkaa") );
+  CHECK( IsWordInList("walkrg") );
+  CHECK( IsWordInList("walked") );
+}